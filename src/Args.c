@@ -10,13 +10,25 @@ static void print(const Args args)
     /* 2 */ "-f: Focal Length           : %f\n"
     /* 3 */ "-v: VSync                  : %s\n"
     /* 4 */ "-m: Mouse Sensitivity      : %f\n"
-    /* 5 */ "-t: CPU Renderer Thread(s) : %d\n",
+    /* 5 */ "-t: CPU Renderer Thread(s) : %d\n"
+    /* 6 */ "-d: Draw Distance          : %f\n"
+    /* 7 */ "-s: Render Scale (%%)       : %d\n"
+    /* 8 */ "-c: Checkerboard (Still)   : %s\n"
+    /* 9 */ "-r: Plane Shading Rate     : %d\n"
+    /* A */ "-w: Wall Segments          : %s\n"
+    /* B */ "-p: CPU Present            : %s\n",
     /* 0 */ args.xres,
     /* 1 */ args.yres,
     /* 2 */ (double) args.focal,
     /* 3 */ args.vsync ? "t" : "f",
     /* 4 */ (double) args.msen,
-    /* 5 */ args.threads);
+    /* 5 */ args.threads,
+    /* 6 */ (double) args.distance,
+    /* 7 */ args.scale,
+    /* 8 */ args.checker ? "t" : "f",
+    /* 9 */ args.rate,
+    /* A */ args.segments ? "t" : "f",
+    /* B */ args.software ? "t" : "f");
 }
 
 static void check(const Args args)
@@ -24,10 +36,17 @@ static void check(const Args args)
     if(args.threads <= 0)
         u_bomb("error: not a valid CPU thread count (-t).\n");
 
-    if(args.xres % args.threads)
-        u_bomb(
-        "error: x-resolution (-x) not divisible by CPU thread count (-t).\n"
-        "change either the number of rendering theads or resolution.\n");
+    if(args.distance < 0.0f)
+        u_bomb("error: not a valid draw distance (-d).\n");
+
+    if(args.scale < A_SCALE_MIN || args.scale > A_SCALE_MAX)
+        u_bomb("error: not a valid render scale (-s), %d to %d percent.\n", A_SCALE_MIN, A_SCALE_MAX);
+
+    if(args.rate != 1 && args.rate != 2 && args.rate != A_RATE_MAX)
+        u_bomb("error: not a valid plane shading rate (-r), 1, 2, or %d.\n", A_RATE_MAX);
+
+    if(args.software && args.vsync)
+        printf("warning: frames put together on the CPU (-p) are presented without vsync (-v).\n");
 
     if(args.xres == 512)
         printf(
@@ -84,6 +103,42 @@ static Args parse(Args args, int argc, char* argv[])
                     strtod(next, NULL);
                 break;
 
+            case 'd':
+                args.distance =
+                    strtof(next, NULL);
+                break;
+
+            case 's':
+                args.scale =
+                    strtod(next, NULL);
+                break;
+
+            case 'c':
+                args.checker =
+                    u_equals(next, "true")  ? 1 : u_equals(next, "t") ? 1 :
+                    u_equals(next, "false") ? 0 : u_equals(next, "f") ? 0 :
+                    strtod(next, NULL) != 0;
+                break;
+
+            case 'r':
+                args.rate =
+                    strtod(next, NULL);
+                break;
+
+            case 'w':
+                args.segments =
+                    u_equals(next, "true")  ? 1 : u_equals(next, "t") ? 1 :
+                    u_equals(next, "false") ? 0 : u_equals(next, "f") ? 0 :
+                    strtod(next, NULL) != 0;
+                break;
+
+            case 'p':
+                args.software =
+                    u_equals(next, "true")  ? 1 : u_equals(next, "t") ? 1 :
+                    u_equals(next, "false") ? 0 : u_equals(next, "f") ? 0 :
+                    strtod(next, NULL) != 0;
+                break;
+
             default:
                 u_bomb("error: option -%c not recognized\n", option);
                 break;
@@ -111,6 +166,25 @@ static Args make(void)
 
     args.msen = 0.007f;
     args.threads = 8;
+
+    // No draw distance, rays march until they are closed off by walls.
+    args.distance = 0.0f;
+
+    // The world is rendered at full resolution unless scaled down (-s, or the minus and equals keys).
+    args.scale = A_SCALE_MAX;
+
+    // Every scanline is rendered every frame unless checkerboarded (-c). Only a still view, of a hero at most turning
+    // on the spot, is checkerboarded. A hero that moves renders every scanline.
+    args.checker = false;
+
+    // Every row of the floor and ceiling is shaded unless far rows are shaded coarsely (-r).
+    args.rate = 1;
+
+    // Walls are found by marching a ray per column unless drawn from segments (-w).
+    args.segments = false;
+
+    // Frames are put together by the renderer SDL picks unless put together on the CPU in the window surface (-p).
+    args.software = false;
     return args;
 }
 
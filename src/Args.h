@@ -1,5 +1,13 @@
 #pragma once
 
+// Render scale limits and hotkey step, in percent of the screen resolution.
+#define A_SCALE_MIN (25)
+#define A_SCALE_MAX (100)
+#define A_SCALE_STEP (5)
+
+// Coarsest plane shading rate, in rows shaded per texel fetch.
+#define A_RATE_MAX (4)
+
 typedef struct
 {
     int xres;
@@ -9,6 +17,12 @@ typedef struct
     int fps;
     float msen;
     int threads;
+    float distance;
+    int scale;
+    int checker;
+    int rate;
+    int segments;
+    int software;
 }
 Args;
 
@@ -1,17 +1,90 @@
 #include "Bundle.h"
 
-#include "Hits.h"
 #include "Scanline.h"
+#include "util.h"
 
+// Rows of a scanline to render. A hero standing still only needs the sky and water of the last frame rendered again,
+// and the scanlines a checkerboard frame mended. Checkerboard frames leave out every other scanline.
+static Clamped rows(const Bundle* const b, const int x)
+{
+    static Clamped none;
+    const Clamped all = { 0, b->sdl.yres };
+    if(b->unmoved)
+        return b->still.stale[x] ? all : b->still.scrolls[x];
+    if(b->checkered)
+        return (x & 1) == b->still.parity ? all : none;
+    return all;
+}
+
+static Scanline scanline(const Bundle* const b, const int x)
+{
+    const Scanline sl = { b->sdl, b->still.pixels, b->still.yres, x, b->rows, b->dark, b->still.scrolls, b->eye };
+    return sl;
+}
+
+int b_project(void* const bundle)
+{
+    const Bundle* const b = (Bundle*) bundle;
+    h_project(b->columns, b->eye, b->band.bot, b->band.top, b->cutoff, b->map, b->edges);
+    return 0;
+}
+
+// The hits of a band of scanlines are all found first, and then the band is taken through the raster stages together,
+// so that the textures and tiles a stage reads for one scanline are still in cache for the next.
 int b_raster(void* const bundle)
 {
     Bundle* const b = (Bundle*) bundle;
-    for(int x = b->a; x < b->b; x++)
+    for(int a; (a = SDL_AtomicAdd(b->column, b->chunk)) < b->sdl.xres;)
     {
-        const Point column = l_lerp(b->camera, x / (float) b->sdl.xres);
-        const Hits hits = h_march(b->hero.where, column, b->map);
-        const Scanline scanline = { b->sdl, b->vram.pixels, b->vram.width, x };
-        b->zbuff[x] = s_raster(scanline, hits, b->hero, b->current, b->clouds, b->map);
+        // Bands are made of the scanlines of the chunk that need rendering.
+        const int end = u_min(a + b->chunk, b->sdl.xres);
+        int x[B_CHUNK];
+        int needs = 0;
+        for(int i = a; i < end; i++)
+        {
+            const Clamped r = rows(b, i);
+            if(r.top > r.bot)
+                x[needs++] = i;
+        }
+        Hits hits[B_CHUNK];
+        if(b->segments)
+            for(int i = 0; i < needs; i++)
+                hits[i] = b->columns[x[i]];
+        else
+            for(int n = 0; n < needs; n += H_LANES)
+            {
+                const int count = u_min(H_LANES, needs - n);
+                Point columns[H_LANES];
+                int bins[H_LANES];
+                int marched = true;
+                for(int i = 0; i < count; i++)
+                {
+                    columns[i] = b->eye.columns[x[n + i]];
+                    bins[i] = f_bin(b->fan, b->eye.yaw + b->eye.angles[x[n + i]]);
+                    marched = marched && f_marched(b->fan, bins[i]);
+                }
+                // A hero that only turned finds most packets already marched by earlier frames.
+                if(!marched)
+                {
+                    h_march_packet(b->hits, b->hero.where, columns, count, b->cutoff, b->map);
+                    for(int i = 0; i < count; i++)
+                        f_keep(b->fan, bins[i], b->hits[i]);
+                }
+                for(int i = 0; i < count; i++)
+                    hits[n + i] = b->fan.hits[bins[i]];
+            }
+        Ray rays[B_CHUNK];
+        for(int i = 0; i < needs; i++)
+            rays[i] = s_raster_wall(scanline(b, x[i]), hits[i], b->hero, b->map, rows(b, x[i]), &b->gaps[i]);
+        for(int i = 0; i < needs; i++)
+            s_raster_planes(scanline(b, x[i]), rays[i], b->map, &b->gaps[i]);
+        for(int i = 0; i < needs; i++)
+            s_raster_sections(scanline(b, x[i]), hits[i], b->hero, b->current, b->clouds, b->map, &b->gaps[i]);
+        for(int i = 0; i < needs; i++)
+        {
+            b->still.zbuff[x[i]] = rays[i].corrected;
+            b->still.stale[x[i]] = false;
+        }
     }
     return 0;
 }
@@ -1,19 +1,45 @@
 #pragma once
 
-#include "Line.h"
+#include "Eye.h"
 #include "Sdl.h"
 #include "Hero.h"
 #include "Flow.h"
 #include "Map.h"
-#include "Vram.h"
+#include "Still.h"
+#include "Hits.h"
+#include "Gaps.h"
+#include "Rows.h"
+#include "Fan.h"
+#include "Edges.h"
+
+// Columns per chunk, rastered together as a band.
+#define B_CHUNK (8)
 
 typedef struct
 {
-    int a;
-    int b;
-    Point* zbuff;
-    Line camera;
-    Vram vram;
+    // Columns are handed out in small chunks from this shared counter
+    // so that no thread sits idle while another finishes a busy part of the screen.
+    SDL_atomic_t* column;
+    int chunk;
+    // Hit buffers for one packet of columns.
+    Hits* hits;
+    // Uncovered spans of each scanline of the band being rastered.
+    Gaps* gaps;
+    Eye eye;
+    // Ray length rays are marched to, and the rays kept from earlier frames.
+    float cutoff;
+    Fan fan;
+    // Walls drawn from segments are projected onto a band of columns per thread, and rastered from the hits of the columns.
+    int segments;
+    Edges edges;
+    Clamped band;
+    Hits* columns;
+    // The frame is rendered over the last one, and only where the sky and water scroll if the hero is unmoved.
+    Still still;
+    int unmoved;
+    int checkered;
+    Rows rows;
+    float dark;
     Sdl sdl;
     Hero hero;
     Flow current;
@@ -22,4 +48,6 @@ typedef struct
 }
 Bundle;
 
+int b_project(void* const bundle);
+
 int b_raster(void* const bundle);
@@ -9,5 +9,3 @@ typedef enum
 Compass;
 
 int c_is_inverted(const Compass);
-
-Compass c_needle(const Point where, const Point other);
@@ -0,0 +1,76 @@
+#include "Crew.h"
+
+#include "util.h"
+
+static int labour(void* const data)
+{
+    Crew* const crew = (Crew*) data;
+
+    SDL_LockMutex(crew->mutex);
+
+    // Workers are told apart by the order they clocked in.
+    const int index = crew->hired++;
+
+    for(int shift = 0; true; shift = crew->shift)
+    {
+        while(crew->shift == shift && !crew->fired)
+            SDL_CondWait(crew->start, crew->mutex);
+        if(crew->fired)
+            break;
+
+        void* const slice = crew->data + index * crew->size;
+        const Job job = crew->job;
+
+        SDL_UnlockMutex(crew->mutex);
+        job(slice);
+        SDL_LockMutex(crew->mutex);
+
+        if(--crew->working == 0)
+            SDL_CondSignal(crew->finish);
+    }
+    SDL_UnlockMutex(crew->mutex);
+    return 0;
+}
+
+Crew* c_hire(const int count)
+{
+    Crew* const crew = u_wipe(Crew, 1);
+    crew->mutex = SDL_CreateMutex();
+    crew->start = SDL_CreateCond();
+    crew->finish = SDL_CreateCond();
+    crew->count = count;
+    crew->threads = u_toss(SDL_Thread*, count);
+    for(int i = 0; i < count; i++)
+        if((crew->threads[i] = SDL_CreateThread(labour, "crew", crew)) == NULL)
+            u_bomb("error: could not hire render thread: %s\n", SDL_GetError());
+    return crew;
+}
+
+void c_work(Crew* const crew, const Job job, void* const data, const int size)
+{
+    SDL_LockMutex(crew->mutex);
+    crew->job = job;
+    crew->data = (char*) data;
+    crew->size = size;
+    crew->working = crew->count;
+    crew->shift++;
+    SDL_CondBroadcast(crew->start);
+    while(crew->working > 0)
+        SDL_CondWait(crew->finish, crew->mutex);
+    SDL_UnlockMutex(crew->mutex);
+}
+
+void c_fire(Crew* const crew)
+{
+    SDL_LockMutex(crew->mutex);
+    crew->fired = true;
+    SDL_CondBroadcast(crew->start);
+    SDL_UnlockMutex(crew->mutex);
+    for(int i = 0; i < crew->count; i++)
+        SDL_WaitThread(crew->threads[i], NULL);
+    SDL_DestroyCond(crew->start);
+    SDL_DestroyCond(crew->finish);
+    SDL_DestroyMutex(crew->mutex);
+    free(crew->threads);
+    free(crew);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+
+typedef int (*Job)(void* const);
+
+// A long lived pool of worker threads. Workers sleep until a shift starts,
+// run the job once with their own slice of the shift data, and then report back.
+// The crew is shared between threads and must stay put in memory, hence the pointer.
+// A fired crew leaves once the shift at hand is done, and is waited on.
+
+typedef struct
+{
+    SDL_Thread** threads;
+    SDL_mutex* mutex;
+    SDL_cond* start;
+    SDL_cond* finish;
+    Job job;
+    char* data;
+    int size;
+    int shift;
+    int working;
+    int hired;
+    int fired;
+    int count;
+}
+Crew;
+
+Crew* c_hire(const int count);
+
+void c_work(Crew* const, const Job, void* const data, const int size);
+
+void c_fire(Crew* const);
@@ -0,0 +1,72 @@
+#include "Edges.h"
+
+#include "util.h"
+
+static const int ex[] = { +1, 0, -1, 0 };
+static const int ey[] = { 0, +1, 0, -1 };
+
+static int tile(char** const block, const int x, const int y)
+{
+    return block[y][x] - ' ';
+}
+
+// A layer is hit where a ray crosses from an open cell into a cell with a surface.
+static int entered(char** const block, const int x, const int y, const int xx, const int yy)
+{
+    return tile(block, x, y) ? 0 : tile(block, xx, yy);
+}
+
+static Edge extract(const Map map, const int x, const int y, const int xx, const int yy)
+{
+    static Edge zero;
+    Edge edge = zero;
+    if(xx < 0 || yy < 0 || xx >= map.cols || yy >= map.rows)
+        return edge;
+    edge.floring = entered(map.floring, x, y, xx, yy);
+    edge.ceiling = entered(map.ceiling, x, y, xx, yy);
+    edge.walling = entered(map.walling, x, y, xx, yy);
+    edge.closes = tile(map.floring, xx, yy) && tile(map.ceiling, xx, yy);
+    return edge;
+}
+
+Edges e_aim(Edges edges, const Map map)
+{
+    if(map.walling == edges.walling && *map.edits == edges.edits)
+        return edges;
+
+    if(map.rows != edges.rows || map.cols != edges.cols)
+    {
+        free(edges.edge);
+        free(edges.mask);
+        edges.rows = map.rows;
+        edges.cols = map.cols;
+        edges.edge = u_toss(Edge, DIRS * edges.rows * edges.cols);
+        edges.mask = u_toss(char, edges.rows * edges.cols);
+    }
+    for(int y = 0; y < edges.rows; y++)
+    for(int x = 0; x < edges.cols; x++)
+    {
+        int mask = 0;
+        for(int e = 0; e < DIRS; e++)
+        {
+            const Edge edge = extract(map, x, y, x + ex[e], y + ey[e]);
+            if(edge.floring || edge.ceiling || edge.walling)
+                mask |= 1 << e;
+            edges.edge[DIRS * (x + y * edges.cols) + e] = edge;
+        }
+        edges.mask[x + y * edges.cols] = mask;
+    }
+    edges.walling = map.walling;
+    edges.edits = *map.edits;
+    return edges;
+}
+
+Edge e_edge(const Edges edges, const int x, const int y, const int e)
+{
+    return edges.edge[DIRS * (x + y * edges.cols) + e];
+}
+
+int e_mask(const Edges edges, const int x, const int y)
+{
+    return edges.mask[x + y * edges.cols];
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Map.h"
+#include "Compass.h"
+
+// Edges leading out of each map cell to its four neighbours, east, south, west and north. Each edge keeps the surfaces
+// a ray crossing into the neighbour hits on the floor, ceiling and eye level layers, the same surfaces a marched ray
+// looks up cell by cell. Edges are extracted once per map and again whenever the map is edited.
+
+typedef struct
+{
+    char floring;
+    char ceiling;
+    char walling;
+
+    // The neighbour has both a floor and a ceiling, ending a ray that has already hit a wall.
+    char closes;
+}
+Edge;
+
+typedef struct
+{
+    // Four edges per cell, and a mask per cell of the edges that hit any surface at all.
+    Edge* edge;
+    char* mask;
+    int rows;
+    int cols;
+
+    // The map the edges were extracted from.
+    char** walling;
+    int edits;
+}
+Edges;
+
+Edges e_aim(Edges, const Map);
+
+Edge e_edge(const Edges, const int x, const int y, const int e);
+
+int e_mask(const Edges, const int x, const int y);
@@ -0,0 +1,72 @@
+#include "Eye.h"
+
+#include "util.h"
+
+#include <math.h>
+
+static Line turn(const Eye eye, const Line line)
+{
+    const Line turned = { e_turn_out(eye, line.a), e_turn_out(eye, line.b) };
+    return turned;
+}
+
+static int same(const Point a, const Point b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+static Eye grind(Eye eye, const Line fov, const int xres)
+{
+    free(eye.columns);
+    free(eye.lens);
+    free(eye.angles);
+    eye.columns = u_toss(Point, xres);
+    eye.lens = u_toss(Point, xres);
+    eye.angles = u_toss(float, xres);
+    for(int x = 0; x < xres; x++)
+    {
+        eye.lens[x] = p_unit(l_lerp(fov, x / (float) xres));
+        eye.angles[x] = atan2f(eye.lens[x].y, eye.lens[x].x);
+    }
+    eye.fov = fov;
+    eye.xres = xres;
+    return eye;
+}
+
+Eye e_focus(Eye eye, const Point where, const float yaw, const Line fov, const float pitch, const float height, const int xres, const int yres)
+{
+    if(xres != eye.xres || !same(fov.a, eye.fov.a) || !same(fov.b, eye.fov.b))
+        eye = grind(eye, fov, xres);
+    eye.where = where;
+    eye.cosine = cosf(yaw);
+    eye.sine = sinf(yaw);
+    eye.yaw = yaw - 2.0f * U_PI * floorf(yaw / (2.0f * U_PI) + 0.5f);
+    eye.camera = turn(eye, fov);
+    eye.focal = fov.a.x;
+    eye.size = eye.focal * 0.5f * xres;
+    eye.mid = pitch * yres / 2.0f;
+    eye.pitch = pitch;
+    eye.height = height;
+    eye.yres = yres;
+    for(int x = 0; x < xres; x++)
+        eye.columns[x] = e_turn_out(eye, eye.lens[x]);
+    return eye;
+}
+
+Point e_turn_in(const Eye eye, const Point a)
+{
+    const Point in = {
+        a.x * eye.cosine + a.y * eye.sine,
+        a.y * eye.cosine - a.x * eye.sine,
+    };
+    return in;
+}
+
+Point e_turn_out(const Eye eye, const Point a)
+{
+    const Point out = {
+        a.x * eye.cosine - a.y * eye.sine,
+        a.x * eye.sine + a.y * eye.cosine,
+    };
+    return out;
+}
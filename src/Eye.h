@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Line.h"
+
+// The eye of the hero. The sine and cosine of the yaw, the focal terms of the projection, and the unit ray direction
+// of every screen column are worked out once a frame, and everything that projects, walls, floors, ceilings and
+// sprites alike, looks through the same eye. The rays of the columns in the space of the eye, and their angles,
+// only change with the field of view and the resolution, and are kept from frame to frame.
+
+typedef struct
+{
+    Point where;
+    float cosine;
+    float sine;
+
+    // The yaw, within half a turn either way.
+    float yaw;
+
+    // The field of view turned by the yaw.
+    Line camera;
+
+    // Screen pixels per unit of height a unit of normal distance away, and the screen row of the horizon.
+    float focal;
+    float size;
+    float mid;
+    float pitch;
+    float height;
+    int xres;
+    int yres;
+
+    // Unit ray directions of the screen columns, as marched rays would have them.
+    Point* columns;
+
+    // Unit ray directions of the screen columns in the space of the eye, and their angles off straight ahead.
+    Line fov;
+    Point* lens;
+    float* angles;
+}
+Eye;
+
+Eye e_focus(Eye, const Point where, const float yaw, const Line fov, const float pitch, const float height, const int xres, const int yres);
+
+// Turns a point relative to the hero into the space of the eye, with x looking ahead, and back out again.
+Point e_turn_in(const Eye, const Point);
+
+Point e_turn_out(const Eye, const Point);
@@ -0,0 +1,53 @@
+#include "Fan.h"
+
+#include "util.h"
+
+#include <math.h>
+
+Fan f_spread(const int xres, const float focal)
+{
+    static Fan zero;
+    Fan fan = zero;
+
+    // Columns are narrowest at the edges of the screen, where the camera line is furthest from the eye.
+    // Bins half as wide as those columns keep every ray within a quarter column of its bin.
+    fan.bins = 2 * (int) ceilf(U_PI * (focal * focal + 1.0f) * xres / focal);
+    fan.hits = u_toss(Hits, fan.bins);
+    for(int i = 0; i < fan.bins; i++)
+        fan.hits[i] = h_new(4);
+    fan.marched = u_wipe(int, fan.bins);
+    fan.generation = 1;
+    return fan;
+}
+
+Fan f_aim(Fan fan, const Point where, const Map map, const float cutoff)
+{
+    if(where.x != fan.where.x || where.y != fan.where.y
+    || map.walling != fan.walling || *map.edits != fan.edits
+    || cutoff != fan.cutoff)
+    {
+        fan.generation++;
+        fan.where = where;
+        fan.walling = map.walling;
+        fan.edits = *map.edits;
+        fan.cutoff = cutoff;
+    }
+    return fan;
+}
+
+int f_bin(const Fan fan, const float angle)
+{
+    const int bin = floorf(angle * fan.bins / (2.0f * U_PI) + 0.5f);
+    return bin < 0 ? bin + fan.bins : bin >= fan.bins ? bin - fan.bins : bin;
+}
+
+int f_marched(const Fan fan, const int bin)
+{
+    return fan.marched[bin] == fan.generation;
+}
+
+void f_keep(const Fan fan, const int bin, const Hits hits)
+{
+    fan.hits[bin] = h_copy(fan.hits[bin], hits);
+    fan.marched[bin] = fan.generation;
+}
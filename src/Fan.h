@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Hits.h"
+
+// Hits of rays marched from the hero, binned by world angle, and kept across frames
+// until the hero moves or the map changes. A hero turning on the spot finds the rays of
+// most columns already marched. Bins are narrower than the narrowest screen column so that
+// no two columns of a frame, and so no two render threads, ever share a bin.
+
+typedef struct
+{
+    Hits* hits;
+
+    // The generation each bin was last marched in. Only bins of the current generation are valid.
+    int* marched;
+    int generation;
+    int bins;
+
+    // Where the rays were marched from, on which map, and for how long.
+    Point where;
+    char** walling;
+    int edits;
+    float cutoff;
+}
+Fan;
+
+Fan f_spread(const int xres, const float focal);
+
+Fan f_aim(Fan, const Point where, const Map, const float cutoff);
+
+// The bin of a ray at an angle of at most one and a half turns either way.
+int f_bin(const Fan, const float angle);
+
+int f_marched(const Fan, const int bin);
+
+void f_keep(const Fan, const int bin, const Hits);
@@ -2,6 +2,14 @@
 
 #include "util.h"
 
+#include <math.h>
+
+static float wrap(const float a)
+{
+    const float w = fmodf(-a, F_WRAP);
+    return w < 0.0f ? w + F_WRAP : w;
+}
+
 Flow f_start(const float height)
 {
     static Flow zero;
@@ -25,5 +33,7 @@ Flow f_stream(Flow f, const Timer tm)
     if(p_mag(f.velocity) > speed)
         f.velocity = p_mul(p_unit(f.velocity), speed);
     f.where = p_add(f.where, f.velocity);
+    f.shift.x = wrap(f.where.x);
+    f.shift.y = wrap(f.where.y);
     return f;
 }
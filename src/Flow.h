@@ -3,6 +3,9 @@
 #include "Point.h"
 #include "Timer.h"
 
+// Sky tiles repeat every eight cells and water every cell.
+#define F_WRAP (8.0f)
+
 typedef struct
 {
     float acceleration;
@@ -10,6 +13,9 @@ typedef struct
     Point direction;
     Point velocity;
     Point where;
+    // Where, negated and wrapped once per tick into a whole number of texture tiles,
+    // so that scrolling planes can sample with a plain translation.
+    Point shift;
     float height;
 }
 Flow;
@@ -0,0 +1,55 @@
+#include "Gaps.h"
+
+#include "util.h"
+
+static Gaps grow(Gaps gaps)
+{
+    gaps.max *= 2;
+    u_retoss(gaps.span, Clamped, gaps.max);
+    u_retoss(gaps.next, Clamped, gaps.max);
+    return gaps;
+}
+
+Gaps g_make(const int max)
+{
+    static Gaps zero;
+    Gaps gaps = zero;
+    gaps.span = u_toss(Clamped, max);
+    gaps.next = u_toss(Clamped, max);
+    gaps.max = max;
+    return gaps;
+}
+
+Gaps g_open(Gaps gaps, const Clamped rows)
+{
+    gaps.span[0] = rows;
+    gaps.count = 1;
+    gaps.nexts = 0;
+    return gaps;
+}
+
+Gaps g_keep(Gaps gaps, const int bot, const int top)
+{
+    if(top <= bot)
+        return gaps;
+    if(gaps.nexts > 0 && gaps.next[gaps.nexts - 1].top == bot)
+    {
+        gaps.next[gaps.nexts - 1].top = top;
+        return gaps;
+    }
+    if(gaps.nexts == gaps.max)
+        gaps = grow(gaps);
+    const Clamped span = { bot, top };
+    gaps.next[gaps.nexts++] = span;
+    return gaps;
+}
+
+Gaps g_swap(Gaps gaps)
+{
+    Clamped* const temp = gaps.span;
+    gaps.span = gaps.next;
+    gaps.next = temp;
+    gaps.count = gaps.nexts;
+    gaps.nexts = 0;
+    return gaps;
+}
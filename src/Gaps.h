@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Clamped.h"
+
+typedef struct
+{
+    // Spans of a scanline no nearer surface has been drawn to yet, bottom to top.
+    // Each render thread owns one of these and reuses the buffers for every scanline it rasters.
+    Clamped* span;
+    int count;
+
+    // Spans the surface being drawn leaves uncovered, swapped in once the surface is done.
+    Clamped* next;
+    int nexts;
+
+    int max;
+}
+Gaps;
+
+Gaps g_make(const int max);
+
+Gaps g_open(Gaps, const Clamped rows);
+
+Gaps g_keep(Gaps, const int bot, const int top);
+
+Gaps g_swap(Gaps);
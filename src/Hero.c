@@ -205,15 +205,15 @@ Hero h_teleport(Hero hero, const Map map, const Point where)
     return h_place(hero, where, hero.floor, hero.height);
 }
 
-Ray h_cast(const Hero hero, const Hit hit, const Sheer sheer, const int yres, const int xres)
+Ray h_cast(const Hero hero, const Eye eye, const Hit hit, const Sheer sheer)
 {
-    const Point end = p_sub(hit.where, hero.where);
+    const Point end = p_sub(hit.where, eye.where);
 
-    const Point corrected = p_turn(end, -hero.yaw);
+    const Point corrected = e_turn_in(eye, end);
 
-    const Line trace = { hero.where, hit.where };
+    const Line trace = { eye.where, hit.where };
 
-    const Projection projection = p_project(yres, xres, hero.fov.a.x, hero.pitch, corrected, hero.height);
+    const Projection projection = p_project(eye, corrected);
 
     const Ray ray = { trace, corrected, p_sheer(projection, sheer), hit.surface, hit.offset, hero.torch };
 
@@ -61,7 +61,7 @@ Hero h_teleport(Hero, const Map, const Point);
 
 Hero h_sustain(Hero, const Map, const Input, const Flow, const Method, const Timer);
 
-Ray h_cast(const Hero, const Hit, const Sheer, const int yres, const int xres);
+Ray h_cast(const Hero, const Eye, const Hit, const Sheer);
 
 Hero h_struck(Hero, const State, const float damage);
 
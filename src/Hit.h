@@ -2,11 +2,10 @@
 
 #include "Point.h"
 
-typedef struct hit
+typedef struct
 {
     int surface;
     float offset;
     Point where;
-    struct hit* next;
 }
 Hit;
@@ -1,62 +1,567 @@
 #include "Hits.h"
 
 #include "Compass.h"
-#include "Line.h"
 #include "util.h"
 
-static Hit* push(Hit* ceiling, const Hit hit)
+#include <math.h>
+#include <float.h>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+static Hits grow(Hits hits)
 {
-    Hit* temp = u_toss(Hit, 1);
-    *temp = hit;
-    temp->next = ceiling;
-    return temp;
+    hits.max *= 2;
+    u_retoss(hits.ceiling, Hit, hits.max);
+    u_retoss(hits.floring, Hit, hits.max);
+    return hits;
 }
 
-static Hit collision(const Point ray, const Line test, char** const block)
+static Hits push_ceiling(Hits hits, const Hit hit)
+{
+    if(hits.ceilings == hits.max)
+        hits = grow(hits);
+    hits.ceiling[hits.ceilings++] = hit;
+    return hits;
+}
+
+static Hits push_floring(Hits hits, const Hit hit)
+{
+    if(hits.florings == hits.max)
+        hits = grow(hits);
+    hits.floring[hits.florings++] = hit;
+    return hits;
+}
+
+static Hit collision(const Point ray, const int surface, const Compass face)
 {
     const float offset = u_dec(ray.x + ray.y);
-    const int inverted = c_is_inverted(c_needle(test.a, test.b));
-    const Hit hit = { p_tile(test.a, block), inverted ? 1.0f - offset : offset, ray, NULL };
+    const Hit hit = { surface, c_is_inverted(face) ? 1.0f - offset : offset, ray };
     return hit;
 }
 
-static Hits step(Hits hits, const Point where, const Point direction, const Map map)
+static int tile(char** const block, const int x, const int y)
+{
+    return block[y][x] - ' ';
+}
+
+static Probe launch(const Point where, const Point direction, const float cutoff)
+{
+    static Probe zero;
+    Probe p = zero;
+    p.where = where;
+    p.direction = direction;
+
+    // Grid cell the ray is in, and the direction it steps through the grid.
+    p.x = where.x;
+    p.y = where.y;
+    p.sx = direction.x > 0.0f ? 1 : -1;
+    p.sy = direction.y > 0.0f ? 1 : -1;
+
+    // A ray parallel to an axis never crosses its grid lines.
+    p.delta.x = direction.x == 0.0f ? FLT_MAX : fabsf(1.0f / direction.x);
+    p.delta.y = direction.y == 0.0f ? FLT_MAX : fabsf(1.0f / direction.y);
+    p.side.x = direction.x == 0.0f ? FLT_MAX : (p.sx > 0 ? p.x + 1 - where.x : where.x - p.x) * p.delta.x;
+    p.side.y = direction.y == 0.0f ? FLT_MAX : (p.sy > 0 ? p.y + 1 - where.y : where.y - p.y) * p.delta.y;
+
+    // Crossings closer than this to a grid corner pass diagonally through the corner.
+    p.corner = 0.001f / p_mag(direction);
+    p.cutoff = cutoff > 0.0f ? cutoff : FLT_MAX;
+    return p;
+}
+
+static Point cross(const Probe p, const float t)
 {
-    const Point hor = p_jump_hor(where, direction);
-    const Point ver = p_jump_ver(where, direction);
-    const Point ray = p_cmp(where, hor, ver);
+    return p_add(p.where, p_mul(p.direction, t));
+}
 
-    const Point delta = p_mul(direction, 0.01f);
+static Probe stride(Probe p)
+{
+    p.bx = p.x;
+    p.by = p.y;
+    p.ray = cross(p, u_min(p.side.x, p.side.y));
+    if(fabsf(p.side.x - p.side.y) < p.corner)
+    {
+        p.ray.x = p.sx > 0 ? p.x + 1 : p.x;
+        p.ray.y = p.sy > 0 ? p.y + 1 : p.y;
+        p.x += p.sx;
+        p.y += p.sy;
+        p.side.x += p.delta.x;
+        p.side.y += p.delta.y;
+        p.face = N;
+    }
+    else if(p.side.x < p.side.y)
+    {
+        p.ray.x = p.sx > 0 ? p.x + 1 : p.x;
+        p.x += p.sx;
+        p.side.x += p.delta.x;
+        p.face = p.sx > 0 ? W : E;
+    }
+    else
+    {
+        p.ray.y = p.sy > 0 ? p.y + 1 : p.y;
+        p.y += p.sy;
+        p.side.y += p.delta.y;
+        p.face = p.sy > 0 ? S : N;
+    }
+    return p;
+}
 
-    const Point dx = { delta.x, 0.0f };
-    const Point dy = { 0.0f, delta.y };
+static int crossings(const float side, const float delta, const float t)
+{
+    return side < t ? u_cl((t - side) / delta) : 0;
+}
+
+// Every cell less than clearance cells away from the probe looks just like the probe's cell,
+// so the probe hops to the last cell the ray reaches inside that square without a single map lookup.
+static Probe skip(Probe p, const Hits hits, const Map map)
+{
+    const int r = m_clearance(map, p.x, p.y) - 1;
+    if(r < 1)
+        return p;
 
-    const Point fixed = p_mag(p_sub(hor, ver)) < 0.001f ? delta : u_dec(ray.x) == 0.0f ? dx : dy;
+    // An eye level wall the probe is stuck inside must still be hit on the next stride.
+    if(tile(map.walling, p.x, p.y) && !hits.walling.surface)
+        return p;
 
-    const Line test = { p_add(ray, fixed), p_sub(ray, fixed) };
+    const float tx = p.delta.x == FLT_MAX ? FLT_MAX : p.side.x + r * p.delta.x;
+    const float ty = p.delta.y == FLT_MAX ? FLT_MAX : p.side.y + r * p.delta.y;
+    const float t = u_min(tx, ty);
+    const int nx = p.delta.x == FLT_MAX ? 0 : u_min(r, crossings(p.side.x, p.delta.x, t));
+    const int ny = p.delta.y == FLT_MAX ? 0 : u_min(r, crossings(p.side.y, p.delta.y, t));
+    p.x += nx * p.sx;
+    p.y += ny * p.sy;
+    p.side.x += nx * p.delta.x;
+    p.side.y += ny * p.delta.y;
+    return p;
+}
 
+static Hits inspect(Hits hits, const Probe p, const Map map)
+{
     // Floor wall.
-    if(p_tile(test.a, map.floring) && !p_tile(test.b, map.floring))
-        hits.floring = push(hits.floring, collision(ray, test, map.floring));
+    if(tile(map.floring, p.x, p.y) && !tile(map.floring, p.bx, p.by))
+        hits = push_floring(hits, collision(p.ray, tile(map.floring, p.x, p.y), p.face));
 
     // Ceiling wall.
-    if(p_tile(test.a, map.ceiling) && !p_tile(test.b, map.ceiling))
-        hits.ceiling = push(hits.ceiling, collision(ray, test, map.ceiling));
+    if(tile(map.ceiling, p.x, p.y) && !tile(map.ceiling, p.bx, p.by))
+        hits = push_ceiling(hits, collision(p.ray, tile(map.ceiling, p.x, p.y), p.face));
 
     // Eye level Wall.
-    if(p_tile(test.a, map.walling) && !hits.walling.surface)
-        hits.walling = collision(ray, test, map.walling);
+    if(tile(map.walling, p.x, p.y) && !hits.walling.surface)
+        hits.walling = collision(p.ray, tile(map.walling, p.x, p.y), p.face);
 
-    // Done casting?
-    if(hits.walling.surface && p_tile(test.a, map.ceiling) && p_tile(test.a, map.floring))
-        return hits;
+    return hits;
+}
+
+static int done(const Hits hits, const int x, const int y, const Map map)
+{
+    return hits.walling.surface && tile(map.ceiling, x, y) && tile(map.floring, x, y);
+}
+
+// A ray that reaches its cutoff ends in fog, which closes off the floor, ceiling and walls that are still open.
+static Hits fog(Hits hits, const Probe p, const Map map)
+{
+    const Hit hit = { 0, 0.0f, cross(p, p.cutoff) };
+    if(!tile(map.floring, p.x, p.y))
+        hits = push_floring(hits, hit);
+    if(!tile(map.ceiling, p.x, p.y))
+        hits = push_ceiling(hits, hit);
+    if(!hits.walling.surface)
+        hits.walling = hit;
+    return hits;
+}
+
+static int beyond(const Probe p)
+{
+    return u_min(p.side.x, p.side.y) > p.cutoff;
+}
+
+static Hits reset(Hits hits)
+{
+    static Hit zero;
+    hits.ceilings = 0;
+    hits.florings = 0;
+    hits.walling = zero;
+    return hits;
+}
 
-    // Else keep on walking.
-    return step(hits, ray, direction, map);
+static Hits walk(Hits hits, Probe p, const Map map)
+{
+    do
+    {
+        p = skip(p, hits, map);
+        if(beyond(p))
+            return fog(hits, p, map);
+        p = stride(p);
+        hits = inspect(hits, p, map);
+    }
+    while(!done(hits, p.x, p.y, map));
+    return hits;
 }
 
-Hits h_march(const Point where, const Point direction, const Map map)
+Hits h_new(const int max)
 {
     static Hits zero;
-    return step(zero, where, direction, map);
+    Hits hits = zero;
+    hits.ceiling = u_toss(Hit, max);
+    hits.floring = u_toss(Hit, max);
+    hits.max = max;
+    return hits;
+}
+
+// Copies the hits of another set, growing the buffers to fit if need be.
+Hits h_copy(Hits hits, const Hits other)
+{
+    while(hits.max < other.ceilings || hits.max < other.florings)
+        hits = grow(hits);
+    memcpy(hits.ceiling, other.ceiling, other.ceilings * sizeof(*hits.ceiling));
+    memcpy(hits.floring, other.floring, other.florings * sizeof(*hits.floring));
+    hits.ceilings = other.ceilings;
+    hits.florings = other.florings;
+    hits.walling = other.walling;
+    return hits;
+}
+
+#ifdef __SSE2__
+
+// While every ray of a packet sits in the same grid cell and steps across the same grid line
+// the map lookups are shared by the packet, and only the grid line distances differ per ray.
+// Returns true if the packet marched to the end together, else the probes are left where the packet
+// split up so that each ray can walk the rest of the way on its own.
+
+static int march_packet(Hits* const hits, Probe* const probe, const Map map)
+{
+    const Probe p = probe[0];
+    for(int i = 1; i < H_LANES; i++)
+        if(probe[i].sx != p.sx || probe[i].sy != p.sy)
+            return false;
+
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 cutoff = _mm_set1_ps(p.cutoff);
+    const __m128 corner = _mm_setr_ps(probe[0].corner, probe[1].corner, probe[2].corner, probe[3].corner);
+    const __m128 dx = _mm_setr_ps(probe[0].delta.x, probe[1].delta.x, probe[2].delta.x, probe[3].delta.x);
+    const __m128 dy = _mm_setr_ps(probe[0].delta.y, probe[1].delta.y, probe[2].delta.y, probe[3].delta.y);
+    __m128 sx = _mm_setr_ps(probe[0].side.x, probe[1].side.x, probe[2].side.x, probe[3].side.x);
+    __m128 sy = _mm_setr_ps(probe[0].side.y, probe[1].side.y, probe[2].side.y, probe[3].side.y);
+
+    int x = p.x;
+    int y = p.y;
+    int finished = false;
+    while(!finished)
+    {
+        const int cornered = _mm_movemask_ps(_mm_cmplt_ps(_mm_andnot_ps(sign, _mm_sub_ps(sx, sy)), corner));
+        const int horizontal = _mm_movemask_ps(_mm_cmplt_ps(sx, sy));
+        if(cornered || (horizontal != 0x0 && horizontal != 0xF))
+            break;
+
+        // Open space is crossed faster by each ray skipping on its own.
+        if(m_clearance(map, x, y) > H_LANES)
+            break;
+
+        // So are the last few grid lines up to the cutoff.
+        if(_mm_movemask_ps(_mm_cmpgt_ps(_mm_min_ps(sx, sy), cutoff)))
+            break;
+
+        const int bx = x;
+        const int by = y;
+
+        float t[H_LANES];
+        Compass face;
+        if(horizontal)
+        {
+            _mm_storeu_ps(t, sx);
+            sx = _mm_add_ps(sx, dx);
+            x += p.sx;
+            face = p.sx > 0 ? W : E;
+        }
+        else
+        {
+            _mm_storeu_ps(t, sy);
+            sy = _mm_add_ps(sy, dy);
+            y += p.sy;
+            face = p.sy > 0 ? S : N;
+        }
+
+        const int floring = tile(map.floring, x, y);
+        const int ceiling = tile(map.ceiling, x, y);
+        const int walling = tile(map.walling, x, y);
+        const int push_f = floring && !tile(map.floring, bx, by);
+        const int push_c = ceiling && !tile(map.ceiling, bx, by);
+        const int push_w = walling && !hits[0].walling.surface;
+
+        if(push_f || push_c || push_w)
+            for(int i = 0; i < H_LANES; i++)
+            {
+                Point ray = cross(probe[i], t[i]);
+                if(horizontal)
+                    ray.x = p.sx > 0 ? bx + 1 : bx;
+                else
+                    ray.y = p.sy > 0 ? by + 1 : by;
+                if(push_f) hits[i] = push_floring(hits[i], collision(ray, floring, face));
+                if(push_c) hits[i] = push_ceiling(hits[i], collision(ray, ceiling, face));
+                if(push_w) hits[i].walling = collision(ray, walling, face);
+            }
+
+        finished = done(hits[0], x, y, map);
+    }
+
+    float side_x[H_LANES];
+    float side_y[H_LANES];
+    _mm_storeu_ps(side_x, sx);
+    _mm_storeu_ps(side_y, sy);
+    for(int i = 0; i < H_LANES; i++)
+    {
+        probe[i].x = x;
+        probe[i].y = y;
+        probe[i].side.x = side_x[i];
+        probe[i].side.y = side_y[i];
+    }
+    return finished;
+}
+
+#else
+
+static int march_packet(Hits* const hits, Probe* const probe, const Map map)
+{
+    (void) hits;
+    (void) probe;
+    (void) map;
+    return false;
+}
+
+#endif
+
+void h_march_packet(Hits* const hits, const Point where, const Point* const directions, const int count, const float cutoff, const Map map)
+{
+    Probe probe[H_LANES];
+    for(int i = 0; i < count; i++)
+    {
+        hits[i] = reset(hits[i]);
+        probe[i] = launch(where, directions[i], cutoff);
+    }
+
+    // Rays that split from the packet, and partial packets, are marched one by one.
+    if(count < H_LANES || !march_packet(hits, probe, map))
+        for(int i = 0; i < count; i++)
+            hits[i] = walk(hits[i], probe[i], map);
+}
+
+// Walls drawn from segments. Cells are visited in rings of growing grid steps from the cell of the hero. A ray takes
+// one grid step further out with every edge it crosses, so the edges of each ring are crossed in the order a marched ray
+// crosses them, and the edges of a ring leading further out are the only ones that face the hero.
+
+// The band of screen columns wall edges are projected onto. Each column looks up the unit direction of its ray
+// in the eye of the frame, and keeps whether its ray has been closed off by the edges projected so far.
+// Cells outside the wedge between the rays of the sides of the band are passed over.
+
+typedef struct
+{
+    Point* directions;
+    char* closed;
+    int open;
+    Line camera;
+    Point forward;
+    Point left;
+    Point right;
+    Point where;
+    float cutoff;
+    int xres;
+    int bot;
+    int top;
+}
+Frustum;
+
+static float dot(const Point a, const Point b)
+{
+    return a.x * b.x + a.y * b.y;
+}
+
+static float perp(const Point a, const Point b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+static Frustum aim(const Eye eye, const int bot, const int top, const float cutoff)
+{
+    static Frustum zero;
+    Frustum f = zero;
+    f.directions = &eye.columns[bot];
+    f.closed = u_wipe(char, top - bot);
+    f.open = top - bot;
+    f.camera = eye.camera;
+    f.forward = p_unit(p_add(eye.camera.a, eye.camera.b));
+    f.left = l_lerp(eye.camera, bot / (float) eye.xres);
+    f.right = l_lerp(eye.camera, top / (float) eye.xres);
+    f.where = eye.where;
+    f.cutoff = cutoff > 0.0f ? cutoff : FLT_MAX;
+    f.xres = eye.xres;
+    f.bot = bot;
+    f.top = top;
+    return f;
+}
+
+// Screen column a point, relative to the hero and in front of the hero, projects to.
+static float column(const Frustum f, const Point v)
+{
+    return f.xres * perp(f.camera.a, v) / perp(v, p_sub(f.camera.b, f.camera.a));
+}
+
+// Crosses the edge of cell x, y leading e, from a to b, with every open column between a and b.
+static void project(Hits* const hits, Frustum* const f, const Edge edge, const int e, const Point a, const Point b)
+{
+    // Edges are clipped just in front of the eye.
+    const float near = 0.001f;
+    const Point va = p_sub(a, f->where);
+    const Point vb = p_sub(b, f->where);
+    const float sa = dot(va, f->forward);
+    const float sb = dot(vb, f->forward);
+    if(sa < near && sb < near)
+        return;
+    const Point ca = sa < near ? p_add(va, p_mul(p_sub(vb, va), (near - sa) / (sb - sa))) : va;
+    const Point cb = sb < near ? p_add(vb, p_mul(p_sub(va, vb), (near - sb) / (sa - sb))) : vb;
+    const float na = column(*f, ca);
+    const float nb = column(*f, cb);
+
+    // Columns a whole column either side are tried as well, and crossings only kept if they land on the edge.
+    const int lo = u_max(ceilf(u_min(na, nb)) - 1.0f, (float) f->bot);
+    const int hi = u_min(floorf(u_max(na, nb)) + 1.0f, (float) (f->top - 1));
+    const int vertical = e == E || e == W;
+    const float slack = 0.001f;
+    for(int x = lo; x <= hi; x++)
+    {
+        const int i = x - f->bot;
+        if(f->closed[i])
+            continue;
+        const Point d = f->directions[i];
+        Point ray = a;
+        float t;
+        if(vertical)
+        {
+            if(d.x == 0.0f)
+                continue;
+            t = (a.x - f->where.x) / d.x;
+            ray.y = f->where.y + d.y * t;
+            if(ray.y < a.y - slack || ray.y > b.y + slack)
+                continue;
+        }
+        else
+        {
+            if(d.y == 0.0f)
+                continue;
+            t = (a.y - f->where.y) / d.y;
+            ray.x = f->where.x + d.x * t;
+            if(ray.x < a.x - slack || ray.x > b.x + slack)
+                continue;
+        }
+        if(t <= 0.0f || t > f->cutoff)
+            continue;
+
+        // Faces are named for the side of the cell entered, as marched.
+        const Compass face = e == E ? W : e == S ? S : e == W ? E : N;
+        if(edge.floring) hits[x] = push_floring(hits[x], collision(ray, edge.floring, face));
+        if(edge.ceiling) hits[x] = push_ceiling(hits[x], collision(ray, edge.ceiling, face));
+        if(edge.walling && !hits[x].walling.surface) hits[x].walling = collision(ray, edge.walling, face);
+        if(edge.closes && hits[x].walling.surface)
+        {
+            f->closed[i] = true;
+            f->open--;
+        }
+    }
+}
+
+static void project_cell(Hits* const hits, Frustum* const f, const Edges edges, const int x, const int y)
+{
+    const int mask = e_mask(edges, x, y);
+    if(!mask)
+        return;
+    const int hx = f->where.x;
+    const int hy = f->where.y;
+    const Point nw = { (float) x, (float) y };
+    const Point ne = { x + 1.0f, (float) y };
+    const Point sw = { (float) x, y + 1.0f };
+    const Point se = { x + 1.0f, y + 1.0f };
+    if((mask & 1 << E) && x >= hx) project(hits, f, e_edge(edges, x, y, E), E, ne, se);
+    if((mask & 1 << S) && y >= hy) project(hits, f, e_edge(edges, x, y, S), S, sw, se);
+    if((mask & 1 << W) && x <= hx) project(hits, f, e_edge(edges, x, y, W), W, nw, sw);
+    if((mask & 1 << N) && y <= hy) project(hits, f, e_edge(edges, x, y, N), N, nw, ne);
+}
+
+// The cells of x0, y0 to x1, y1 are outside the band if all corners of their box are on the far side of one side of the band.
+static int outside(const Frustum* const f, const int x0, const int y0, const int x1, const int y1)
+{
+    const Point corner[] = {
+        { (float) u_min(x0, x1), (float) u_min(y0, y1) },
+        { (float) u_max(x0, x1) + 1.0f, (float) u_min(y0, y1) },
+        { (float) u_min(x0, x1), (float) u_max(y0, y1) + 1.0f },
+        { (float) u_max(x0, x1) + 1.0f, (float) u_max(y0, y1) + 1.0f },
+    };
+    int left = 0;
+    int right = 0;
+    for(int i = 0; i < 4; i++)
+    {
+        const Point v = p_sub(corner[i], f->where);
+        left += perp(f->left, v) < 0.0f;
+        right += perp(v, f->right) < 0.0f;
+    }
+    return left == 4 || right == 4;
+}
+
+// Each of the four sides of a ring is passed over as a whole when outside the band, and else cell by cell.
+static void project_ring(Hits* const hits, Frustum* const f, const Edges edges, const int k)
+{
+    const int hx = f->where.x;
+    const int hy = f->where.y;
+    if(k == 0)
+        project_cell(hits, f, edges, hx, hy);
+    for(int q = 0; q < 4 && k > 0; q++)
+    {
+        const int dx[] = { k, 0, -k, 0, k };
+        const int dy[] = { 0, k, 0, -k, 0 };
+        const int sx = dx[q + 1] - dx[q] > 0 ? 1 : -1;
+        const int sy = dy[q + 1] - dy[q] > 0 ? 1 : -1;
+        const int ax = hx + dx[q];
+        const int ay = hy + dy[q];
+        if(outside(f, ax, ay, ax + sx * (k - 1), ay + sy * (k - 1)))
+            continue;
+        for(int i = 0; i < k; i++)
+        {
+            const int x = ax + sx * i;
+            const int y = ay + sy * i;
+            if(x >= 0 && y >= 0 && x < edges.cols && y < edges.rows && !outside(f, x, y, x, y))
+                project_cell(hits, f, edges, x, y);
+        }
+    }
+}
+
+void h_project(Hits* const hits, const Eye eye, const int bot, const int top, const float cutoff, const Map map, const Edges edges)
+{
+    if(bot >= top)
+        return;
+    Frustum f = aim(eye, bot, top, cutoff);
+    for(int x = bot; x < top; x++)
+        hits[x] = reset(hits[x]);
+
+    // Edges a ring of k grid steps out are no nearer than (k - 2) / sqrt(2).
+    const int rings = u_min(f.cutoff * sqrtf(2.0f) + 2.0f, (float) (edges.rows + edges.cols));
+    for(int k = 0; k <= rings && f.open > 0; k++)
+        project_ring(hits, &f, edges, k);
+
+    // Columns left open end in fog at the cutoff. Columns that slipped between edges, which only rays grazing
+    // a grid corner can, are marched instead.
+    for(int x = bot; x < top; x++)
+        if(!f.closed[x - bot])
+        {
+            Probe p = launch(eye.where, f.directions[x - bot], cutoff);
+            const Point end = cross(p, p.cutoff);
+            if(m_out_of_bounds(map, end))
+                hits[x] = walk(reset(hits[x]), p, map);
+            else
+            {
+                p.x = end.x;
+                p.y = end.y;
+                hits[x] = fog(hits[x], p, map);
+            }
+        }
+    free(f.closed);
 }
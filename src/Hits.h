@@ -3,18 +3,39 @@
 #include "Point.h"
 #include "Map.h"
 #include "Hit.h"
+#include "Probe.h"
+#include "Edges.h"
+#include "Eye.h"
+
+// Adjacent screen columns are marched together in packets of this many rays.
+#define H_LANES (4)
 
 typedef struct
 {
-    // Linked lists for the ceiling and floor renderer.
-    // Free these hits as they are used.
+    // Ceiling and floor wall hits for the ceiling and floor renderer, nearest first.
+    // Each render thread owns one of these and reuses the buffers for every column it marches,
+    // growing them if a ray ever crosses more than max walls.
     Hit* ceiling;
     Hit* floring;
+    int ceilings;
+    int florings;
+    int max;
 
-    // No linked list needed for the wall renderer as the
+    // Only one hit needed for the wall renderer as the
     // foremost wall will overlap walls behind it.
     Hit walling;
 }
 Hits;
 
-Hits h_march(const Point where, const Point direction, const Map);
+Hits h_new(const int max);
+
+Hits h_copy(Hits, const Hits);
+
+// Rays end in fog past the cutoff ray length, or march on until closed off by walls if the cutoff is zero.
+
+void h_march_packet(Hits* const, const Point where, const Point* const directions, const int count, const float cutoff, const Map);
+
+// Walls drawn from segments. Fills the hits of screen columns bot to top by projecting the map edges facing the hero,
+// giving each column the hits a marched ray would find.
+
+void h_project(Hits* const, const Eye, const int bot, const int top, const float cutoff, const Map, const Edges);
@@ -31,6 +31,10 @@ Input i_pump(Input input)
     input.lm = input.m;
     input.lr = input.r;
 
+    const int rescale = input.key[SDL_SCANCODE_EQUALS] - input.key[SDL_SCANCODE_MINUS];
+    input.rescale = rescale == input.lrescale ? 0 : rescale;
+    input.lrescale = rescale;
+
     SDL_GetMouseState(&input.x, &input.y);
 
     return input;
@@ -64,6 +68,11 @@ int i_using_lookup(const Input in)
     return in.key[SDL_SCANCODE_BACKSPACE];
 }
 
+int i_rescaling(const Input in)
+{
+    return in.rescale;
+}
+
 int i_get_alpha_key(const Input in)
 {
     if(in.key[SDL_SCANCODE_A]) return 'A';
@@ -41,6 +41,10 @@ typedef struct
     int ll;
     int lm;
     int lr;
+
+    // Render scale keys, -1 for down and +1 for up on the frame they are pressed, and their last state.
+    int rescale;
+    int lrescale;
 }
 Input;
 
@@ -54,6 +58,8 @@ int i_using_world_edit_mode(const Input);
 
 int i_using_lookup(const Input);
 
+int i_rescaling(const Input);
+
 int i_get_alpha_key(const Input);
 
 int i_get_numer_key(const Input);
@@ -0,0 +1,21 @@
+#pragma once
+
+// Where a surface lives in the flat texel array of the scanline renderer.
+// Walls sample a surface along its rows, which run down the screen as scanlines are rendered sideways,
+// so the rows are kept as they are. Floors and ceilings sample a surface in every direction,
+// so square power of two surfaces get a second copy in Z-order.
+// Square power of two surfaces also carry mip levels down to a single texel, for distant surfaces.
+
+// Mip levels a surface may carry, enough for surfaces of 32768 pixels a side.
+#define L_LEVELS (16)
+
+typedef struct
+{
+    int rows;
+    int zorder;
+    int swizzled;
+    int levels;
+    int w;
+    int h;
+}
+Layout;
@@ -9,6 +9,4 @@ typedef struct
 }
 Line;
 
-Line l_rotate(const Line, const float t);
-
 Point l_lerp(const Line, const float n);
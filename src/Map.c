@@ -19,8 +19,9 @@ static char** make(const int rows, const int cols, const int blok)
 {
     char** block = u_toss(char*, rows);
 
+    // Padded so that the vector plane casts can gather tiles with 32-bit loads.
     for(int row = 0; row < rows; row++)
-        block[row] = u_toss(char, cols);
+        block[row] = u_toss(char, cols + sizeof(int) - 1);
 
     return reset(block, rows, cols, blok);
 }
@@ -44,6 +45,8 @@ Map m_generate(const int rows, const int cols, const Points trapdoors, const Poi
     map.ceiling = make(map.rows, map.cols, '#');
     map.walling = make(map.rows, map.cols, '#');
     map.floring = make(map.rows, map.cols, '"');
+    map.clearance = make(map.rows, map.cols, 0);
+    map.edits = u_wipe(int, 1);
     map.trapdoors = trapdoors;
     map.rooms = r_init(interests, floor);
     map.top = top;
@@ -102,6 +105,94 @@ int m_out_of_bounds(const Map map, const Point where)
         || (int) where.y >= map.rows || (int) where.y < 0;
 }
 
+// Clearance cells keep their distance in the lower bits,
+// and the layers the distance was surveyed for in the upper bits.
+static const int reach = 0x0F;
+
+static int layers(const Map map, const int x, const int y)
+{
+    return (map.walling[y][x] != ' ') << 0
+         | (map.ceiling[y][x] != ' ') << 1
+         | (map.floring[y][x] != ' ') << 2;
+}
+
+static int on_edge(const Map map, const int x, const int y)
+{
+    if(x == 0 || y == 0 || x == map.cols - 1 || y == map.rows - 1)
+        return true;
+
+    const int here = layers(map, x, y);
+    for(int j = -1; j <= 1; j++)
+    for(int i = -1; i <= 1; i++)
+        if(layers(map, x + i, y + j) != here)
+            return true;
+    return false;
+}
+
+static void relax(const Map map, const int x, const int y, const int xx, const int yy)
+{
+    if(xx < 0 || yy < 0 || xx >= map.cols || yy >= map.rows)
+        return;
+
+    const int distance = m_clearance(map, xx, yy) + 1;
+    if(distance < m_clearance(map, x, y))
+        map.clearance[y][x] = (map.clearance[y][x] & ~reach) | distance;
+}
+
+// Two pass chamfer over a window of the map. Cells just outside the window keep their distances
+// and seed the cells inside, so a window reaching one cell past a change is all that needs redoing.
+static void survey(const Map map, const int x0, const int y0, const int x1, const int y1)
+{
+    const int l = u_max(x0, 0);
+    const int t = u_max(y0, 0);
+    const int r = u_min(x1, map.cols - 1);
+    const int b = u_min(y1, map.rows - 1);
+
+    *map.edits += 1;
+
+    for(int y = t; y <= b; y++)
+    for(int x = l; x <= r; x++)
+        map.clearance[y][x] = layers(map, x, y) << 4 | (on_edge(map, x, y) ? 1 : reach);
+
+    for(int y = t; y <= b; y++)
+    for(int x = l; x <= r; x++)
+    {
+        relax(map, x, y, x - 1, y + 0);
+        relax(map, x, y, x - 1, y - 1);
+        relax(map, x, y, x + 0, y - 1);
+        relax(map, x, y, x + 1, y - 1);
+    }
+
+    for(int y = b; y >= t; y--)
+    for(int x = r; x >= l; x--)
+    {
+        relax(map, x, y, x + 1, y + 0);
+        relax(map, x, y, x + 1, y + 1);
+        relax(map, x, y, x + 0, y + 1);
+        relax(map, x, y, x - 1, y + 1);
+    }
+}
+
+static void resurvey(const Map map, const int x, const int y)
+{
+    if((map.clearance[y][x] >> 4) == layers(map, x, y))
+        return;
+
+    // Cells past the reach of the clamp can not tell the difference.
+    const int w = reach + 1;
+    survey(map, x - w, y - w, x + w, y + w);
+}
+
+void m_survey(const Map map)
+{
+    survey(map, 0, 0, map.cols - 1, map.rows - 1);
+}
+
+int m_clearance(const Map map, const int x, const int y)
+{
+    return map.clearance[y][x] & reach;
+}
+
 void m_edit(const Map map, const Overview ov)
 {
     if(m_out_of_bounds(map, ov.where))
@@ -118,6 +209,10 @@ void m_edit(const Map map, const Overview ov)
     if(ov.party == FLORING) map.floring[y][x] = ascii;
     if(ov.party == WALLING) map.walling[y][x] = ascii;
     if(ov.party == CEILING) map.ceiling[y][x] = ascii;
+
+    // Swapping one wall surface for another leaves the layers, and so the survey, as they were.
+    *map.edits += 1;
+    resurvey(map, x, y);
 }
 
 void m_place_room(const Map map, const Point where, const int w, const int h, const Party p)
@@ -245,6 +340,15 @@ static void place_pass(const Map map, const int x, const int y)
     place_cross(map, x, y, '!', ' ');
 }
 
+static void resurvey_cross(const Map map, const int x, const int y)
+{
+    const int end = map.grid / 2;
+    resurvey(map, x + end, y + 0);
+    resurvey(map, x - end, y + 0);
+    resurvey(map, x + 0, y + end);
+    resurvey(map, x + 0, y - end);
+}
+
 void m_place_barricades(const Map map)
 {
     for(int i = 0; i < map.rooms.count; i++)
@@ -259,6 +363,13 @@ void m_place_barricades(const Map map)
         if(map.rooms.room[i].agents == 0)
             place_pass(map, mid.x, mid.y);
     }
+
+    // Doors are put down and taken back up every frame, but only doors that changed need a new survey.
+    for(int i = 0; i < map.rooms.count; i++)
+    {
+        const Point mid = map.rooms.room[i].where;
+        resurvey_cross(map, mid.x, mid.y);
+    }
 }
 
 int m_min(const Map map)
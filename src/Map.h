@@ -13,6 +13,13 @@ typedef struct
     char** walling;
     char** floring;
 
+    // Chebyshev distance, in cells, from each cell to the nearest cell where any of the three layers
+    // above change, clamped to a short reach. Rays use it to jump across stretches of open space.
+    char** clearance;
+
+    // Bumped whenever the map is edited or its layers change, for renderers keeping rays across frames.
+    int* edits;
+
     int rows;
     int cols;
 
@@ -52,6 +59,10 @@ void m_lay_corridor(const Map, const Point a, const Point b);
 
 void m_place_barricades(const Map);
 
+void m_survey(const Map);
+
+int m_clearance(const Map, const int x, const int y);
+
 int m_min(const Map);
 
 int m_max(const Map);
@@ -0,0 +1,111 @@
+#include "Palette.h"
+
+#include "util.h"
+
+static uint32_t shade(const uint32_t pixel, const int shading)
+{
+    const uint32_t r = (((pixel >> 0x10) /****/) * shading) >> 0x08;
+    const uint32_t g = (((pixel >> 0x08) & 0xFF) * shading) >> 0x08;
+    const uint32_t b = (((pixel /*****/) & 0xFF) * shading) >> 0x08;
+    return r << 0x10 | g << 0x08 | b;
+}
+
+Palette p_empty(void)
+{
+    static Palette zero;
+    Palette palette = zero;
+    palette.color = u_toss(uint32_t, P_COLORS);
+    return palette;
+}
+
+void p_free(const Palette palette)
+{
+    free(palette.color);
+    free(palette.shades);
+}
+
+// Loads a JASC palette. Repeated colors are only kept once, leaving room for any colors
+// the art uses that the palette lacks. Palettes from grafx2 may list fewer colors than they say.
+Palette p_load_palette(const char* const path)
+{
+    FILE* const file = fopen(path, "r");
+    if(file == NULL)
+        u_bomb("Could not open %s\n", path);
+
+    int count = 0;
+    if(fscanf(file, "JASC-PAL %*d %d", &count) != 1)
+        u_bomb("%s is not a JASC palette\n", path);
+
+    Palette palette = p_empty();
+    for(int i = 0; i < count; i++)
+    {
+        int r = 0;
+        int g = 0;
+        int b = 0;
+        if(fscanf(file, "%d %d %d", &r, &g, &b) != 3)
+            break;
+        palette = p_match(palette, r << 0x10 | g << 0x08 | b);
+    }
+    fclose(file);
+    return palette;
+}
+
+Palette p_match(Palette palette, const uint32_t color)
+{
+    if(p_index(palette, color) != -1)
+        return palette;
+    if(palette.count == P_COLORS)
+    {
+        if(palette.dropped++ == 0)
+            printf("warning: art uses more than %d colors, the rest are drawn in the nearest color.\n", P_COLORS);
+        return palette;
+    }
+    palette.color[palette.count++] = color;
+    return palette;
+}
+
+int p_index(const Palette palette, const uint32_t color)
+{
+    for(int i = 0; i < palette.count; i++)
+        if(palette.color[i] == color)
+            return i;
+    return -1;
+}
+
+// The index of a color, or of its nearest color if the palette was full.
+int p_entry(const Palette palette, const uint32_t color)
+{
+    const int index = p_index(palette, color);
+    return index == -1 ? p_nearest(palette, color) : index;
+}
+
+static int channel(const uint32_t a, const uint32_t b, const int shift)
+{
+    const int d = (int) (0xFF & (a >> shift)) - (int) (0xFF & (b >> shift));
+    return d * d;
+}
+
+int p_nearest(const Palette palette, const uint32_t color)
+{
+    int nearest = 0;
+    int best = INT_MAX;
+    for(int i = 0; i < palette.count; i++)
+    {
+        const int distance = channel(palette.color[i], color, 0x10) + channel(palette.color[i], color, 0x08) + channel(palette.color[i], color, 0x00);
+        if(distance < best)
+        {
+            best = distance;
+            nearest = i;
+        }
+    }
+    return nearest;
+}
+
+Palette p_shade(Palette palette)
+{
+    palette.shades = u_wipe(uint32_t, 0x100 * P_COLORS);
+    for(int light = 0; light < 0x100; light++)
+    for(int i = 0; i < palette.count; i++)
+        palette.shades[light << 8 | i] = shade(palette.color[i], light);
+    return palette;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+
+// Textures are stored as indices into this palette. Every color is shaded ahead of time
+// at every light level so that shading a texel is a single lookup.
+
+#define P_COLORS (256)
+
+typedef struct
+{
+    uint32_t* color;
+    int count;
+
+    // Colors that found the palette full, and are drawn in the nearest color instead.
+    int dropped;
+
+    // Light level major: shades[light << 8 | index].
+    uint32_t* shades;
+}
+Palette;
+
+Palette p_empty(void);
+
+void p_free(const Palette);
+
+Palette p_load_palette(const char* const path);
+
+Palette p_match(Palette, const uint32_t color);
+
+int p_index(const Palette, const uint32_t color);
+
+int p_entry(const Palette, const uint32_t color);
+
+int p_nearest(const Palette, const uint32_t color);
+
+Palette p_shade(Palette);
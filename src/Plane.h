@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Point.h"
+
+// A floor, ceiling, sky or pit plane cast down a scanline by one ray.
+
+typedef struct
+{
+    // Step across the plane per row inverse, and the inverse of its length for the light falloff.
+    Point step;
+    float reach;
+
+    // Surface widths a row covers, per squared row inverse, for picking mip levels.
+    float footprint;
+
+    // Ceilings cast from one row up.
+    int up;
+
+    // Without a backdrop the surfaces of the tiles are drawn where there are tiles.
+    // With a backdrop the backdrop is drawn where there are no tiles, or everywhere if there are no tiles.
+    char** tiles;
+    int backdrop;
+
+    // Scrolling backdrops are textured by their scaled offset from a wrapped flow shift.
+    int scrolls;
+    Point shift;
+    float scale;
+}
+Plane;
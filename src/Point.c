@@ -75,22 +75,6 @@ float p_slope(const Point a)
     return a.y / a.x;
 }
 
-Point p_jump_hor(const Point a, const Point b)
-{
-    Point out;
-    out.x = b.x > 0.0f ? u_fl(a.x + 1.0f) : u_cl(a.x - 1.0f);
-    out.y = p_slope(b) * (out.x - a.x) + a.y;
-    return out;
-}
-
-Point p_jump_ver(const Point a, const Point b)
-{
-    Point out;
-    out.y = b.y > 0.0f ? u_fl(a.y + 1.0f) : u_cl(a.y - 1.0f);
-    out.x = (out.y - a.y) / p_slope(b) + a.x;
-    return out;
-}
-
 Point p_mid(const Point a)
 {
     const Point out = {
@@ -100,17 +84,6 @@ Point p_mid(const Point a)
     return out;
 }
 
-int p_inf(const Point a)
-{
-    return isinf((long double) a.x)
-        || isinf((long double) a.y);
-}
-
-Point p_cmp(const Point a, const Point b, const Point c)
-{
-    return p_inf(c) ? b : p_inf(b) ? c : p_mag(p_sub(b, a)) < p_mag(p_sub(c, a)) ? b : c;
-}
-
 int p_eql(const Point a, const Point b, const float e)
 {
     return a.x < b.x + (e / 2.0f)
@@ -25,16 +25,8 @@ Point p_unit(const Point);
 
 float p_slope(const Point);
 
-Point p_jump_hor(const Point a, const Point b);
-
-Point p_jump_ver(const Point a, const Point b);
-
 Point p_mid(const Point);
 
-int p_inf(const Point);
-
-Point p_cmp(const Point a, const Point b, const Point c);
-
 int p_eql(const Point a, const Point b, const float e);
 
 int p_same(const Point a, const Point b);
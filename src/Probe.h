@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Point.h"
+#include "Compass.h"
+
+// The grid walking state of a ray being marched through the map.
+// Side is the ray length (in units of direction) up to the next vertical and horizontal grid line,
+// and delta is the ray length between two grid lines. The last grid line crossed is kept
+// along with the cell the ray came from. The ray ends in fog at the cutoff ray length.
+
+typedef struct
+{
+    Point where;
+    Point direction;
+    Point delta;
+    Point side;
+    float corner;
+    float cutoff;
+    int x;
+    int y;
+    int sx;
+    int sy;
+
+    Point ray;
+    Compass face;
+    int bx;
+    int by;
+}
+Probe;
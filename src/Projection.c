@@ -4,20 +4,20 @@
 
 #include <math.h>
 
-Projection p_project(const int yres, const int xres, const float focal, const float pitch, const Point corrected, const float height)
+Projection p_project(const Eye eye, const Point corrected)
 {
     const float min = 1e-5;
     const float normal = corrected.x < min ? min : corrected.x;
 
     static Projection zero;
     Projection p = zero;
-    p.size = focal * 0.5f * xres / normal;
-    p.mid = pitch * yres / 2.0f;
-    p.bot = p.mid + (0.0f - height) * p.size;
-    p.top = p.mid + (1.0f - height) * p.size;
-    p.clamped = c_clamp(yres, p.bot, p.top);
-    p.height = height;
-    p.yres = yres;
+    p.size = eye.size / normal;
+    p.mid = eye.mid;
+    p.bot = p.mid + (0.0f - eye.height) * p.size;
+    p.top = p.mid + (1.0f - eye.height) * p.size;
+    p.clamped = c_clamp(eye.yres, p.bot, p.top);
+    p.height = eye.height;
+    p.yres = eye.yres;
     p.sheer.a = 0.0f;
     p.sheer.b = 0.0f;
     return p;
@@ -34,12 +34,15 @@ Projection p_sheer(Projection p, const Sheer s)
     return p;
 }
 
-float p_ceil_cast(const Projection p, const int x)
+// Height of the ceiling and floor planes from the eye. A screen row x casts to the plane
+// height * size / (x - mid) of the way along the ray, one row up for ceilings.
+
+float p_ceil_plane(const Projection p)
 {
-    return (1.0f - p.height + p.sheer.b) * p.size / (x + 1 - p.mid);
+    return 1.0f - p.height + p.sheer.b;
 }
 
-float p_flor_cast(const Projection p, const int x)
+float p_flor_plane(const Projection p)
 {
-    return (0.0f - p.height - p.sheer.a) * p.size / (x + 0 - p.mid);
+    return 0.0f - p.height - p.sheer.a;
 }
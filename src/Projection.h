@@ -3,6 +3,7 @@
 #include "Point.h"
 #include "Clamped.h"
 #include "Sheer.h"
+#include "Eye.h"
 
 typedef struct
 {
@@ -17,10 +18,10 @@ typedef struct
 }
 Projection;
 
-Projection p_project(const int yres, const int xres, const float focal, const float pitch, const Point corrected, const float height);
+Projection p_project(const Eye, const Point corrected);
 
 Projection p_sheer(const Projection, const Sheer);
 
-float p_ceil_cast(const Projection, const int x);
+float p_ceil_plane(const Projection);
 
-float p_flor_cast(const Projection, const int x);
+float p_flor_plane(const Projection);
@@ -0,0 +1,20 @@
+#include "Rows.h"
+
+#include "util.h"
+
+Rows r_make(const int yres, const float pitch)
+{
+    static Rows zero;
+    Rows rows = zero;
+    rows.yres = yres;
+    rows.mid = pitch * yres / 2.0f;
+    rows.inverse = u_toss(float, yres + 1);
+    for(int x = 0; x <= yres; x++)
+        rows.inverse[x] = 1.0f / (x - rows.mid);
+    return rows;
+}
+
+void r_free(const Rows rows)
+{
+    free(rows.inverse);
+}
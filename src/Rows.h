@@ -0,0 +1,17 @@
+#pragma once
+
+// Floor and ceiling casts land a distance along each ray that scales with the inverse of how far a screen row
+// sits from the horizon. The horizon only moves with the pitch of the hero, so the inverses are worked out once a frame.
+
+typedef struct
+{
+    // One more row than the screen as ceiling casts look one row up.
+    float* inverse;
+    float mid;
+    int yres;
+}
+Rows;
+
+Rows r_make(const int yres, const float pitch);
+
+void r_free(const Rows);
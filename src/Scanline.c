@@ -1,21 +1,29 @@
 #include "Scanline.h"
 
+#include "Plane.h"
 #include "util.h"
 
-static uint32_t shade_pixel(const uint32_t pixel, const int shading)
+#include <math.h>
+
+static int get_wall_index(const Surfaces surfaces, const int tile, const Point offset)
 {
-    const uint32_t r = (((pixel >> 0x10) /****/) * shading) >> 0x08; // Shift right by 0x08 is same as
-    const uint32_t g = (((pixel >> 0x08) & 0xFF) * shading) >> 0x08; // dividing by 256. Somehow
-    const uint32_t b = (((pixel /*****/) & 0xFF) * shading) >> 0x08; // gcc -Ofast was not catching this.
-    return r << 0x10 | g << 0x08 | b;
+    const Layout layout = surfaces.layout[tile];
+    const int row = layout.h * u_dec(offset.y);
+    const int col = layout.w * u_dec(offset.x);
+    return surfaces.texels[layout.rows + col + row * layout.w];
 }
 
-static uint32_t get_pixel(const SDL_Surface* const surface, const Point offset)
+// Footprint is the distance, in surface widths, a pixel of a scanline covers on a surface.
+static int get_plane_index(const Surfaces surfaces, const int tile, const Point offset, const float footprint)
 {
-    const int row = surface->h * u_dec(offset.y);
-    const int col = surface->w * u_dec(offset.x);
-    const uint32_t* const pixels = (uint32_t*) surface->pixels;
-    return pixels[col + row * surface->w];
+    const Layout layout = surfaces.layout[tile];
+    if(!layout.swizzled)
+        return get_wall_index(surfaces, tile, offset);
+    const int level = s_level(layout, footprint * layout.w);
+    const int n = layout.w >> level;
+    const int row = n * u_dec(offset.y);
+    const int col = n * u_dec(offset.x);
+    return surfaces.texels[layout.zorder + s_mip(layout, level) + s_zorder(col, row)];
 }
 
 static void set_pixel(const Scanline sl, const int x, const uint32_t pixel)
@@ -23,122 +31,525 @@ static void set_pixel(const Scanline sl, const int x, const uint32_t pixel)
     sl.pixels[x + sl.y * sl.width] = pixel;
 }
 
-static void pixel_xfer(const Scanline sl, const int x, const Point offset, const int tile, const int distance)
+static void pixel_xfer(const Scanline sl, const int x, const int index, const int distance)
+{
+    set_pixel(sl, x, sl.sdl.surfaces.palette.shades[distance << 8 | index]);
+}
+
+// Floor and ceiling casts step across a plane by scaling the trace of the ray with the row inverses of the frame.
+// The distance falls off linearly with the row, so the light needs neither a square root nor a divide per pixel.
+
+static Plane plane(const Ray r, const float height, const int up, char** const tiles, const int backdrop)
+{
+    static Plane zero;
+    Plane p = zero;
+    p.step = p_mul(p_sub(r.trace.b, r.trace.a), height * r.proj.size);
+    p.reach = 1.0f / p_mag(p.step);
+    p.footprint = p_mag(p.step);
+    p.up = up;
+    p.tiles = tiles;
+    p.backdrop = backdrop;
+    return p;
+}
+
+static Plane scroll(Plane p, const Flow f, const float scale)
 {
-    const uint32_t color = get_pixel(sl.sdl.surfaces.surface[tile], offset);
-    set_pixel(sl, x, shade_pixel(color, distance));
+    p.scrolls = true;
+    p.shift = f.shift;
+    p.scale = scale;
+    p.footprint *= scale;
+    return p;
 }
 
-static void raster_wall(const Scanline sl, const Ray r)
+// Reference plane shade of one row. Returns true if the row is to be drawn.
+static int shade(const Scanline sl, const Ray r, const Plane p, const int x, uint32_t* const pixel)
 {
-    for(int x = r.proj.clamped.bot; x < r.proj.clamped.top; x++)
+    const int row = x + p.up;
+    const Point offset = p_add(r.trace.a, p_mul(p.step, sl.rows.inverse[row]));
+    const int tile = p.tiles ? p_tile(offset, p.tiles) : 0;
+    if(p.backdrop ? tile : !tile)
+        return false;
+    const float inverse = p.reach * fabsf(row - sl.rows.mid);
+    const int lum = t_fade(t_shine(r.torch, inverse), inverse, sl.sdl.distance);
+    const Point texel = p.scrolls ? p_mul(p_abs(p_add(offset, p.shift)), p.scale) : offset;
+    const float footprint = p.footprint * sl.rows.inverse[row] * sl.rows.inverse[row];
+    const int index = get_plane_index(sl.sdl.surfaces, p.backdrop ? p.backdrop : tile, texel, footprint);
+    *pixel = sl.sdl.surfaces.palette.shades[lum << 8 | index];
+    return true;
+}
+
+// True if a row of the plane is to be drawn, as shaded, without shading it.
+static int draws(const Scanline sl, const Ray r, const Plane p, const int x)
+{
+    const int row = x + p.up;
+    const Point offset = p_add(r.trace.a, p_mul(p.step, sl.rows.inverse[row]));
+    const int tile = p.tiles ? p_tile(offset, p.tiles) : 0;
+    return p.backdrop ? !tile : tile;
+}
+
+// Far rows are shaded in aligned runs of rows, each run by its row furthest from the horizon.
+// Planes that fill the gaps of others shade the same rows, so no run is left undrawn by both.
+static int furthest(const Scanline sl, const Plane p, const int x, const int rate)
+{
+    const int first = x & ~(rate - 1);
+    return p.up ? u_min(first + rate, sl.sdl.yres) - 1 : first;
+}
+
+// Reference plane cast of rows x to end, a run or the end of one. Returns true if the rows were drawn.
+static int cast(const Scanline sl, const Ray r, const Plane p, const int x, const int end, const int rate)
+{
+    uint32_t pixel;
+    if(!shade(sl, r, p, furthest(sl, p, x, rate), &pixel))
+        return false;
+    for(int i = x; i < end; i++)
+        set_pixel(sl, i, pixel);
+    return true;
+}
+
+// Rows cast at once by the vector plane casts.
+#define S_LANES (8)
+
+#if L_LEVELS > 2 * S_LANES
+#error "mip levels of a surface do not fit the mip tables of the vector casts"
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+
+#include <immintrin.h>
+
+// Vector plane casts are only run if the CPU says it has AVX2.
+#define S_AVX2 __attribute__((target("avx2")))
+
+// Map rows are padded so that tiles can be gathered with 32-bit loads.
+static S_AVX2 __m256i gather_tiles(char** const tiles, const __m256 ox, const __m256 oy)
+{
+    const __m256i ix = _mm256_cvttps_epi32(ox);
+    const __m256i iy = _mm256_cvttps_epi32(oy);
+
+    // Near the eye many rows land in one tile, which is looked up just the once.
+    const __m256i x0 = _mm256_permutevar8x32_epi32(ix, _mm256_setzero_si256());
+    const __m256i y0 = _mm256_permutevar8x32_epi32(iy, _mm256_setzero_si256());
+    const __m256i same = _mm256_and_si256(_mm256_cmpeq_epi32(ix, x0), _mm256_cmpeq_epi32(iy, y0));
+    if(_mm256_movemask_epi8(same) == -1)
     {
-        const Point offset = { (x - r.proj.bot) / r.proj.size, r.offset };
-        const int lum = t_illuminate(r.torch, r.corrected.x);
-        pixel_xfer(sl, x, offset, r.surface, lum);
+        const int x = _mm256_cvtsi256_si32(ix);
+        const int y = _mm256_cvtsi256_si32(iy);
+        return _mm256_set1_epi32(tiles[y][x] - ' ');
     }
+
+    // Row pointers are gathered as doubles, which are only moved and never looked at as doubles.
+    const __m256d none = _mm256_setzero_pd();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi32(-1));
+    const __m256i lo = _mm256_castpd_si256(_mm256_mask_i32gather_pd(none, (const double*) tiles, _mm256_castsi256_si128(iy), all, 8));
+    const __m256i hi = _mm256_castpd_si256(_mm256_mask_i32gather_pd(none, (const double*) tiles, _mm256_extracti128_si256(iy, 1), all, 8));
+    const __m256i at_lo = _mm256_add_epi64(lo, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(ix)));
+    const __m256i at_hi = _mm256_add_epi64(hi, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(ix, 1)));
+    const __m128i chars_lo = _mm256_i64gather_epi32((const int*) 0, at_lo, 1);
+    const __m128i chars_hi = _mm256_i64gather_epi32((const int*) 0, at_hi, 1);
+    const __m256i chars = _mm256_inserti128_si256(_mm256_castsi128_si256(chars_lo), chars_hi, 1);
+    return _mm256_sub_epi32(_mm256_and_si256(chars, _mm256_set1_epi32(0xFF)), _mm256_set1_epi32(' '));
 }
 
-static void raster_flor(const Scanline sl, const Ray r, const Map map)
+static S_AVX2 __m256i spread_lanes(__m256i a)
 {
-    for(int x = 0; x < r.proj.clamped.bot; x++)
+    a = _mm256_and_si256(_mm256_or_si256(a, _mm256_slli_epi32(a, 8)), _mm256_set1_epi32(0x00FF00FF));
+    a = _mm256_and_si256(_mm256_or_si256(a, _mm256_slli_epi32(a, 4)), _mm256_set1_epi32(0x0F0F0F0F));
+    a = _mm256_and_si256(_mm256_or_si256(a, _mm256_slli_epi32(a, 2)), _mm256_set1_epi32(0x33333333));
+    a = _mm256_and_si256(_mm256_or_si256(a, _mm256_slli_epi32(a, 1)), _mm256_set1_epi32(0x55555555));
+    return a;
+}
+
+// Casts S_LANES runs of rate rows from x up like the reference cast. Returns a mask of the runs drawn,
+// or -1 if the runs need more than one tile surface and must be cast one at a time.
+static S_AVX2 int cast_lanes(const Scanline sl, const Ray r, const Plane p, const int x, const int rate)
+{
+    const int row = furthest(sl, p, x, rate) + p.up;
+    const __m256i rows = _mm256_add_epi32(_mm256_set1_epi32(row), _mm256_mullo_epi32(_mm256_set1_epi32(rate), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    const __m256 inverse = rate == 1 ? _mm256_loadu_ps(&sl.rows.inverse[row]) : _mm256_i32gather_ps(sl.rows.inverse, rows, 4);
+    const __m256 ox = _mm256_add_ps(_mm256_set1_ps(r.trace.a.x), _mm256_mul_ps(_mm256_set1_ps(p.step.x), inverse));
+    const __m256 oy = _mm256_add_ps(_mm256_set1_ps(r.trace.a.y), _mm256_mul_ps(_mm256_set1_ps(p.step.y), inverse));
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i tile = p.tiles ? gather_tiles(p.tiles, ox, oy) : zero;
+    const __m256i empty = _mm256_cmpeq_epi32(tile, zero);
+    const __m256i draw = p.backdrop ? empty : _mm256_xor_si256(empty, _mm256_set1_epi32(-1));
+    const int drawn = _mm256_movemask_ps(_mm256_castsi256_ps(draw));
+    if(drawn == 0x00)
+        return drawn;
+
+    int surface = p.backdrop;
+    if(!surface)
+    {
+        int tiles[S_LANES];
+        _mm256_storeu_si256((__m256i*) tiles, tile);
+        surface = tiles[__builtin_ctz(drawn)];
+        const __m256i same = _mm256_cmpeq_epi32(tile, _mm256_set1_epi32(surface));
+        if((_mm256_movemask_ps(_mm256_castsi256_ps(same)) & drawn) != drawn)
+            return -1;
+    }
+
+    const __m256 distance = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_sub_ps(_mm256_cvtepi32_ps(rows), _mm256_set1_ps(sl.rows.mid)));
+    const __m256 shine = _mm256_mul_ps(_mm256_set1_ps(p.reach), distance);
+    const __m256 light = _mm256_mul_ps(_mm256_set1_ps((float) r.torch.light), shine);
+    __m256i lum = _mm256_cvttps_epi32(_mm256_min_ps(light, _mm256_set1_ps(255.0f)));
+    if(sl.sdl.distance != 0.0f)
+    {
+        const __m256 fog = _mm256_sub_ps(_mm256_mul_ps(shine, _mm256_set1_ps(sl.sdl.distance)), _mm256_set1_ps(1.0f));
+        const __m256 fade = _mm256_min_ps(_mm256_max_ps(fog, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+        lum = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(lum), fade));
+    }
+
+    __m256 tx = ox;
+    __m256 ty = oy;
+    if(p.scrolls)
+    {
+        // Sheared skies can be cast past the edge of the map, where the texture mirrors.
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+        tx = _mm256_mul_ps(_mm256_andnot_ps(sign, _mm256_add_ps(ox, _mm256_set1_ps(p.shift.x))), _mm256_set1_ps(p.scale));
+        ty = _mm256_mul_ps(_mm256_andnot_ps(sign, _mm256_add_ps(oy, _mm256_set1_ps(p.shift.y))), _mm256_set1_ps(p.scale));
+    }
+    const Layout layout = sl.sdl.surfaces.layout[surface];
+    const __m256 fx = _mm256_sub_ps(tx, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(tx)));
+    const __m256 fy = _mm256_sub_ps(ty, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(ty)));
+    __m256i index;
+    if(layout.swizzled)
+    {
+        // Each lane picks its own mip level from the exponent of its texel density.
+        const __m256 footprint = _mm256_mul_ps(_mm256_set1_ps(p.footprint), _mm256_mul_ps(inverse, inverse));
+        const __m256 density = _mm256_mul_ps(footprint, _mm256_set1_ps((float) layout.w));
+        const __m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(_mm256_castps_si256(density), 23), _mm256_set1_epi32(127));
+        const __m256i level = _mm256_min_epi32(_mm256_max_epi32(exponent, zero), _mm256_set1_epi32(layout.levels - 1));
+        // Mip offsets are looked up in two tables of eight levels, the second for levels past the seventh.
+        int mips[2 * S_LANES];
+        for(int i = 0; i < 2 * S_LANES; i++)
+            mips[i] = s_mip(layout, u_min(i, layout.levels - 1));
+        const __m256i low = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((__m256i*) &mips[0]), level);
+        const __m256i high = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((__m256i*) &mips[S_LANES]), level);
+        const __m256i past = _mm256_cmpgt_epi32(level, _mm256_set1_epi32(S_LANES - 1));
+        const __m256i mip = _mm256_blendv_epi8(low, high, past);
+        const __m256 n = _mm256_cvtepi32_ps(_mm256_srlv_epi32(_mm256_set1_epi32(layout.w), level));
+        const __m256i col = _mm256_cvttps_epi32(_mm256_mul_ps(n, fx));
+        const __m256i line = _mm256_cvttps_epi32(_mm256_mul_ps(n, fy));
+        const __m256i zorder = _mm256_or_si256(spread_lanes(col), _mm256_slli_epi32(spread_lanes(line), 1));
+        index = _mm256_add_epi32(_mm256_add_epi32(_mm256_set1_epi32(layout.zorder), mip), zorder);
+    }
+    else
     {
-        const Point offset = l_lerp(r.trace, p_flor_cast(r.proj, x));
-        const int tile = p_tile(offset, map.floring);
-        if(!tile)
-            continue;
-        const int lum = t_illuminate(r.torch, p_mag(p_sub(offset, r.trace.a)));
-        pixel_xfer(sl, x, offset, tile, lum);
+        const __m256i col = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_set1_ps((float) layout.w), fx));
+        const __m256i line = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_set1_ps((float) layout.h), fy));
+        index = _mm256_add_epi32(_mm256_set1_epi32(layout.rows), _mm256_add_epi32(col, _mm256_mullo_epi32(line, _mm256_set1_epi32(layout.w))));
     }
+    const __m256i bytes = _mm256_mask_i32gather_epi32(zero, (const int*) sl.sdl.surfaces.texels, index, draw, 1);
+    const __m256i shade = _mm256_or_si256(_mm256_slli_epi32(lum, 8), _mm256_and_si256(bytes, _mm256_set1_epi32(0xFF)));
+    const __m256i color = _mm256_mask_i32gather_epi32(zero, (const int*) sl.sdl.surfaces.palette.shades, shade, draw, 4);
+    if(rate == 1)
+        _mm256_maskstore_epi32((int*) &sl.pixels[x + sl.y * sl.width], draw, color);
+    else
+    {
+        uint32_t colors[S_LANES];
+        _mm256_storeu_si256((__m256i*) colors, color);
+        for(int i = 0; i < S_LANES; i++)
+            if((drawn >> i) & 0x1)
+                for(int j = 0; j < rate; j++)
+                    set_pixel(sl, x + i * rate + j, colors[i]);
+    }
+    return drawn;
+}
+
+#else
+
+static int cast_lanes(const Scanline sl, const Ray r, const Plane p, const int x, const int rate)
+{
+    (void) sl;
+    (void) r;
+    (void) p;
+    (void) x;
+    (void) rate;
+    return -1;
 }
 
-static void raster_ceil(const Scanline sl, const Ray r, const Map map)
+#endif
+
+static Gaps keep(Gaps gaps, int* const run, const int x, const int end)
+{
+    gaps = g_keep(gaps, *run, x);
+    *run = end;
+    return gaps;
+}
+
+// Casts rows bot to top of a plane in runs of rate rows, keeping the rows left undrawn as gaps.
+static Gaps cast_rows(const Scanline sl, const Ray r, const Plane p, const int bot, const int top, const int rate, Gaps gaps)
 {
-    for(int x = r.proj.clamped.top; x < sl.sdl.yres; x++)
+    int run = bot;
+    int x = bot;
+    while(x < top)
     {
-        const Point offset = l_lerp(r.trace, p_ceil_cast(r.proj, x));
-        const int tile = p_tile(offset, map.ceiling);
-        if(!tile)
-            continue;
-        const int lum = t_illuminate(r.torch, p_mag(p_sub(offset, r.trace.a)));
-        pixel_xfer(sl, x, offset, tile, lum);
+        if(sl.sdl.simd && !(x & (rate - 1)) && x + S_LANES * rate <= top)
+        {
+            const int drawn = cast_lanes(sl, r, p, x, rate);
+            for(int i = 0; i < S_LANES; i++, x += rate)
+                if(drawn < 0 ? cast(sl, r, p, x, x + rate, rate) : (drawn >> i) & 0x1)
+                    gaps = keep(gaps, &run, x, x + rate);
+        }
+        else
+        {
+            const int end = u_min((x | (rate - 1)) + 1, top);
+            if(cast(sl, r, p, x, end, rate))
+                gaps = keep(gaps, &run, x, end);
+            x = end;
+        }
     }
+    return g_keep(gaps, run, top);
+}
+
+// Rows further than this are shaded once for every two rows, and once for every four past twice as far, down to the shading rate.
+#define S_COARSE (4.0f)
+
+// Rows of a plane further than the distance sit this close to the horizon.
+static Clamped beyond(const Scanline sl, const Plane p, const float distance)
+{
+    const float band = 1.0f / (p.reach * distance);
+    const Clamped b = {
+        (int) ceilf(u_max(sl.rows.mid - band - p.up, 0.0f)),
+        (int) floorf(u_min(sl.rows.mid + band - p.up, (float) sl.sdl.yres)) + 1,
+    };
+    return b;
 }
 
-static void raster_sky(const Scanline sl, const Ray r, const Map map, const int floor, const Flow clouds)
+// Casts rows bot to top of a plane, coarsening the rate with the distance of the rows.
+static Gaps cast_span(const Scanline sl, const Ray r, const Plane p, const int bot, const int top, const int rate, const float distance, Gaps gaps)
 {
-    if(floor == 0)
+    if(rate >= sl.sdl.rate)
+        return cast_rows(sl, r, p, bot, top, rate, gaps);
+    const Clamped c = beyond(sl, p, distance);
+    const int cb = u_min(u_max(bot, c.bot), top);
+    const int ct = u_max(u_min(top, c.top), cb);
+    gaps = cast_rows(sl, r, p, bot, cb, rate, gaps);
+    gaps = cast_span(sl, r, p, cb, ct, 2 * rate, 2.0f * distance, gaps);
+    return cast_rows(sl, r, p, ct, top, rate, gaps);
+}
+
+// Surfaces are drawn nearest first. Each one only draws to the gaps nearer surfaces left behind,
+// and keeps what it did not cover itself as the gaps for the surfaces behind it.
+
+// Reference wall pixel.
+static void wall_pixel(const Scanline sl, const Ray r, const int lum, const int x)
+{
+    const Point offset = { (x - r.proj.bot) / r.proj.size, r.offset };
+    pixel_xfer(sl, x, get_wall_index(sl.sdl.surfaces, r.surface, offset), lum);
+}
+
+// The light and the texture row of a wall do not change down a scanline. Walls with a power of two width
+// step the texture column in 16.16 fixed point and wrap it with a mask.
+static void wall_span(const Scanline sl, const Ray r, const int lum, const int bot, const int top)
+{
+    const Layout layout = sl.sdl.surfaces.layout[r.surface];
+    if(layout.w & (layout.w - 1))
+    {
+        for(int x = bot; x < top; x++)
+            wall_pixel(sl, r, lum, x);
+        return;
+    }
+    // Far walls pick the mip level that is close to a texel per pixel.
+    const int level = s_level(layout, layout.w / r.proj.size);
+    const int w = layout.w >> level;
+    const int h = layout.h >> level;
+    const int row = h * u_dec(r.offset);
+    const uint8_t* const texels = &sl.sdl.surfaces.texels[layout.rows + s_mip(layout, level) + row * w];
+    const uint32_t* const shades = &sl.sdl.surfaces.palette.shades[lum << 8];
+    const int mask = (w << 16) - 1;
+    // At least a step, for a hero pressed right up against the wall.
+    const int step = u_max(w / r.proj.size * 65536.0f, 1.0f);
+    int u = w * u_dec((bot - r.proj.bot) / r.proj.size) * 65536.0f;
+    uint32_t* const pixels = &sl.pixels[sl.y * sl.width];
+
+    // Magnified walls, like walls right in front of the hero, shade each texel once and fill its run of pixels.
+    if(step < 1 << 15)
     {
-        for(int x = r.proj.clamped.top; x < sl.sdl.yres; x++)
+        for(int x = bot; x < top;)
         {
-            const Sheer sa = { 0.0f, clouds.height };
-            const Point a = l_lerp(r.trace, p_ceil_cast(p_sheer(r.proj, sa), x));
-            const int lum = t_illuminate(r.torch, p_mag(p_sub(a, r.trace.a)));
-            pixel_xfer(sl, x, p_div(p_abs(p_sub(a, clouds.where)), 8.0f), '&' - ' ', lum);
+            const int next = ((u >> 16) + 1) << 16;
+            const int run = (next - u + step - 1) / step;
+            const int end = u_min(x + run, top);
+            const uint32_t color = shades[texels[u >> 16]];
+            for(; x < end; x++)
+                pixels[x] = color;
+            u = (u + run * step) & mask;
         }
+        return;
     }
-    else
-        for(int x = r.proj.clamped.top; x < sl.sdl.yres; x++)
+    for(int x = bot; x < top; x++)
+    {
+        pixels[x] = shades[texels[u >> 16]];
+        u = (u + step) & mask;
+    }
+}
+
+// Pixels out of the light, and the fog past the draw distance, are all the unlit shade of any texel,
+// and are filled without a texel fetch.
+static void dark_span(const Scanline sl, const int bot, const int top)
+{
+    const uint32_t dark = sl.sdl.surfaces.palette.shades[0];
+    uint32_t* const pixels = &sl.pixels[sl.y * sl.width];
+    for(int x = bot; x < top; x++)
+        pixels[x] = dark;
+}
+
+// Rays that end at the draw distance hit a wall of fog.
+static Gaps raster_wall(const Scanline sl, const Ray r, Gaps gaps)
+{
+    const int lum = t_fade(t_illuminate(r.torch, r.corrected.x), 1.0f / r.corrected.x, sl.sdl.distance);
+    for(int i = 0; i < gaps.count; i++)
+    {
+        const Clamped gap = gaps.span[i];
+        const int bot = u_max(gap.bot, r.proj.clamped.bot);
+        const int top = u_min(gap.top, r.proj.clamped.top);
+        if(r.surface && lum)
+            wall_span(sl, r, lum, bot, top);
+        else
+            dark_span(sl, bot, top);
+        gaps = g_keep(gaps, gap.bot, u_min(gap.top, r.proj.clamped.bot));
+        gaps = g_keep(gaps, u_max(gap.bot, r.proj.clamped.top), gap.top);
+    }
+    return g_swap(gaps);
+}
+
+// Rows of a plane this close to the horizon are further away than the dark, and are left unlit without casting.
+// Walls go dark by their normal distance, so the rows do too. Rows along a ray are further away than they are
+// along the normal by the length of the trace over its normal distance.
+static Clamped horizon(const Scanline sl, const Ray r, const Plane p)
+{
+    const Clamped h = { 0, sl.sdl.yres };
+    return sl.dark == 0.0f ? h : beyond(sl, p, sl.dark * p_mag(p_sub(r.trace.b, r.trace.a)) / r.corrected.x);
+}
+
+// Rows of a plane out of the light are filled dark where the plane draws, and kept as gaps where it does not.
+static Gaps dark_rows(const Scanline sl, const Ray r, const Plane p, const int bot, const int top, Gaps gaps)
+{
+    int run = bot;
+    for(int x = bot; x < top; x++)
+        if(draws(sl, r, p, x))
         {
-            const Point offset = l_lerp(r.trace, p_ceil_cast(r.proj, x));
-            if(p_tile(offset, map.ceiling))
-                continue;
-            const int lum = t_illuminate(r.torch, p_mag(p_sub(offset, r.trace.a)));
-            pixel_xfer(sl, x, offset, '#' - ' ', lum);
+            dark_span(sl, x, x + 1);
+            gaps = keep(gaps, &run, x, x + 1);
         }
+    return g_keep(gaps, run, top);
+}
+
+static void scrolled(const Scanline sl, const int bot, const int top)
+{
+    Clamped* const s = &sl.scrolls[sl.y];
+    if(s->bot == s->top)
+    {
+        s->bot = bot;
+        s->top = top;
+    }
+    else
+    {
+        s->bot = u_min(s->bot, bot);
+        s->top = u_max(s->top, top);
+    }
 }
 
-static void raster_pit(const Scanline sl, const Ray r, const Map map, const Flow current)
+// Planes only draw to rows bot to top of the gaps.
+static Gaps raster_plane(const Scanline sl, const Ray r, const Plane p, const int bot, const int top, Gaps gaps)
 {
-    for(int x = 0; x < r.proj.clamped.bot; x++)
+    const Clamped h = horizon(sl, r, p);
+    for(int i = 0; i < gaps.count; i++)
     {
-        const Point offset = l_lerp(r.trace, p_flor_cast(r.proj, x));
-        if(p_tile(offset, map.floring))
-            continue;
-        const int lum = t_illuminate(r.torch, p_mag(p_sub(offset, r.trace.a)));
-        pixel_xfer(sl, x, p_abs(p_sub(offset, current.where)), '%' - ' ', lum);
+        const Clamped gap = gaps.span[i];
+        const int b = u_max(gap.bot, bot);
+        const int t = u_min(gap.top, top);
+        if(b < t)
+        {
+            if(p.scrolls)
+                scrolled(sl, b, t);
+            const int hb = u_min(u_max(b, h.bot), t);
+            const int ht = u_max(u_min(t, h.top), hb);
+            gaps = g_keep(gaps, gap.bot, b);
+            gaps = cast_span(sl, r, p, b, hb, 1, S_COARSE, gaps);
+            gaps = dark_rows(sl, r, p, hb, ht, gaps);
+            gaps = cast_span(sl, r, p, ht, t, 1, S_COARSE, gaps);
+            gaps = g_keep(gaps, t, gap.top);
+        }
+        else
+            gaps = g_keep(gaps, gap.bot, gap.top);
     }
+    return g_swap(gaps);
+}
+
+static Gaps raster_flor(const Scanline sl, const Ray r, const Map map, const Gaps gaps)
+{
+    const Plane p = plane(r, p_flor_plane(r.proj), 0, map.floring, 0);
+    return raster_plane(sl, r, p, 0, r.proj.clamped.bot, gaps);
+}
+
+static Gaps raster_ceil(const Scanline sl, const Ray r, const Map map, const Gaps gaps)
+{
+    const Plane p = plane(r, p_ceil_plane(r.proj), 1, map.ceiling, 0);
+    return raster_plane(sl, r, p, r.proj.clamped.top, sl.sdl.yres, gaps);
+}
+
+static Gaps raster_sky(const Scanline sl, const Ray r, const Map map, const int floor, const Flow clouds, const Gaps gaps)
+{
+    const Sheer sa = { 0.0f, clouds.height };
+    const Plane p = floor == 0
+        ? scroll(plane(r, p_ceil_plane(p_sheer(r.proj, sa)), 1, NULL, '&' - ' '), clouds, 1.0f / 8.0f)
+        : plane(r, p_ceil_plane(r.proj), 1, map.ceiling, '#' - ' ');
+    return raster_plane(sl, r, p, r.proj.clamped.top, sl.sdl.yres, gaps);
+}
+
+static Gaps raster_pit(const Scanline sl, const Ray r, const Map map, const Flow current, const Gaps gaps)
+{
+    const Plane p = scroll(plane(r, p_flor_plane(r.proj), 0, map.floring, '%' - ' '), current, 1.0f);
+    return raster_plane(sl, r, p, 0, r.proj.clamped.bot, gaps);
 }
 
-static void raster_upper_section(const Scanline sl, const Hits hits, const Hero hero, const Map map, const Flow clouds)
+static Gaps raster_upper_section(const Scanline sl, const Hits hits, const Hero hero, const Map map, const Flow clouds, Gaps gaps)
 {
-    int link = 0;
-    for(Hit* hit = hits.ceiling, *next; hit; next = hit->next, free(hit), hit = next)
+    for(int i = 0; i < hits.ceilings && gaps.count > 0; i++)
     {
-        const Hit* const which = hit;
-        const Ray ray = h_cast(hero, *which, map.top, sl.sdl.yres, sl.sdl.xres);
-        if(link++ == 0)
-            raster_sky(sl, ray, map, hero.floor, clouds);
-        raster_wall(sl, ray);
+        const Ray ray = h_cast(hero, sl.eye, hits.ceiling[i], map.top);
+        gaps = raster_wall(sl, ray, gaps);
+        if(i == hits.ceilings - 1)
+            gaps = raster_sky(sl, ray, map, hero.floor, clouds, gaps);
     }
+    return gaps;
 }
 
-static void raster_lower_section(const Scanline sl, const Hits hits, const Hero hero, const Map map, const Flow current)
+static Gaps raster_lower_section(const Scanline sl, const Hits hits, const Hero hero, const Map map, const Flow current, Gaps gaps)
 {
-    int link = 0;
-    for(Hit* hit = hits.floring, *next; hit; next = hit->next, free(hit), hit = next)
+    for(int i = 0; i < hits.florings && gaps.count > 0; i++)
     {
-        const Hit* const which = hit;
         const Sheer sheer = { current.height, -1.0f };
-        const Ray ray = h_cast(hero, *which, sheer, sl.sdl.yres, sl.sdl.xres);
-        if(link++ == 0)
-            raster_pit(sl, ray, map, current);
-        raster_wall(sl, ray);
+        const Ray ray = h_cast(hero, sl.eye, hits.floring[i], sheer);
+        gaps = raster_wall(sl, ray, gaps);
+        if(i == hits.florings - 1)
+            gaps = raster_pit(sl, ray, map, current, gaps);
     }
+    return gaps;
+}
+
+// The wall of the middle section is drawn first. Only rows bot to top of the scanline are rastered.
+Ray s_raster_wall(const Scanline sl, const Hits hits, const Hero hero, const Map map, const Clamped rows, Gaps* const gaps)
+{
+    static Clamped none;
+    sl.scrolls[sl.y] = none;
+    *gaps = g_open(*gaps, rows);
+    const Ray ray = h_cast(hero, sl.eye, hits.walling, map.mid);
+    *gaps = raster_wall(sl, ray, *gaps);
+    return ray;
 }
 
-static Point raster_middle_section(const Scanline sl, const Hits hits, const Hero hero, const Map map)
+// The floor and ceiling of the middle section sit in front of everything the upper and lower sections draw.
+void s_raster_planes(const Scanline sl, const Ray ray, const Map map, Gaps* const gaps)
 {
-    const Ray ray = h_cast(hero, hits.walling, map.mid, sl.sdl.yres, sl.sdl.xres);
-    raster_wall(sl, ray);
-    raster_flor(sl, ray, map);
-    raster_ceil(sl, ray, map);
-    return ray.corrected;
+    *gaps = raster_flor(sl, ray, map, *gaps);
+    *gaps = raster_ceil(sl, ray, map, *gaps);
 }
 
-Point s_raster(const Scanline sl, const Hits hits, const Hero hero, const Flow current, const Flow clouds, const Map map)
+void s_raster_sections(const Scanline sl, const Hits hits, const Hero hero, const Flow current, const Flow clouds, const Map map, Gaps* const gaps)
 {
-    raster_upper_section(sl, hits, hero, map, clouds);
-    raster_lower_section(sl, hits, hero, map, current);
-    return raster_middle_section(sl, hits, hero, map);
+    *gaps = raster_lower_section(sl, hits, hero, map, current, *gaps);
+    *gaps = raster_upper_section(sl, hits, hero, map, clouds, *gaps);
 }
@@ -2,6 +2,9 @@
 
 #include "Sdl.h"
 #include "Hits.h"
+#include "Gaps.h"
+#include "Rows.h"
+#include "Ray.h"
 
 typedef struct
 {
@@ -11,7 +14,26 @@ typedef struct
 
     // Scanlines are rotated 90 degrees.
     int y;
+
+    // Row inverses for floor and ceiling casts, shared by every scanline of the frame.
+    Rows rows;
+
+    // Distance past which nothing is lit.
+    float dark;
+
+    // Rows of each scanline the scrolling sky and water were cast to.
+    Clamped* scrolls;
+
+    // The eye every scanline of the frame is projected through.
+    Eye eye;
 }
 Scanline;
 
-Point s_raster(const Scanline, const Hits, const Hero, const Flow current, const Flow clouds, const Map);
+// Scanlines are rastered in stages, each scanline keeping its own gaps from one stage to the next,
+// so that a band of scanlines can be taken through each stage together.
+
+Ray s_raster_wall(const Scanline, const Hits, const Hero, const Map, const Clamped rows, Gaps* const);
+
+void s_raster_planes(const Scanline, const Ray, const Map, Gaps* const);
+
+void s_raster_sections(const Scanline, const Hits, const Hero, const Flow current, const Flow clouds, const Map, Gaps* const);
@@ -4,8 +4,13 @@
 #include "Frame.h"
 #include "Scanline.h"
 #include "Bundle.h"
+#include "Vram.h"
 #include "util.h"
 
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
 static void churn(const Sdl sdl)
 {
     const SDL_Rect dst = {
@@ -17,36 +22,164 @@ static void churn(const Sdl sdl)
     SDL_RenderCopyEx(sdl.renderer, sdl.canvas, NULL, &dst, -90, NULL, SDL_FLIP_NONE);
 }
 
+static int scaled(const int res, const int scale)
+{
+    return u_max(res * scale / 100, 1);
+}
+
+// The resolution the world is rendered at.
+static Sdl view(Sdl sdl)
+{
+    sdl.xres = scaled(sdl.xres, sdl.scale);
+    sdl.yres = scaled(sdl.yres, sdl.scale);
+    return sdl;
+}
+
+// The frame is kept for the next frame to render over, and copied to the canvas.
+static void develop(const Sdl sdl, const Still still)
+{
+    const Vram vram = v_lock(sdl.canvas);
+    for(int x = 0; x < still.xres; x++)
+        memcpy(&vram.pixels[x * vram.width], &still.pixels[x * still.yres], still.yres * sizeof(*still.pixels));
+    v_unlock(sdl.canvas);
+}
+
+// Frames put together on the CPU are transposed upright into the window surface in square blocks,
+// so that both the columns read and the rows written stay in cache.
+#define S_BLOCK (32)
+
+#ifdef __SSE2__
+
+// Transposes four rows of four scanlines at once. Rows of a scanline run up the screen.
+static void turn_quad(const Vram vram, const Still still, const int x, const int y)
+{
+    const uint32_t* const from = &still.pixels[x * still.yres + y];
+    const __m128i a = _mm_loadu_si128((const __m128i*) &from[0 * still.yres]);
+    const __m128i b = _mm_loadu_si128((const __m128i*) &from[1 * still.yres]);
+    const __m128i c = _mm_loadu_si128((const __m128i*) &from[2 * still.yres]);
+    const __m128i d = _mm_loadu_si128((const __m128i*) &from[3 * still.yres]);
+    const __m128i ab_lo = _mm_unpacklo_epi32(a, b);
+    const __m128i ab_hi = _mm_unpackhi_epi32(a, b);
+    const __m128i cd_lo = _mm_unpacklo_epi32(c, d);
+    const __m128i cd_hi = _mm_unpackhi_epi32(c, d);
+    uint32_t* const to = &vram.pixels[x + (still.yres - 1 - y) * vram.width];
+    _mm_storeu_si128((__m128i*) &to[-0 * vram.width], _mm_unpacklo_epi64(ab_lo, cd_lo));
+    _mm_storeu_si128((__m128i*) &to[-1 * vram.width], _mm_unpackhi_epi64(ab_lo, cd_lo));
+    _mm_storeu_si128((__m128i*) &to[-2 * vram.width], _mm_unpacklo_epi64(ab_hi, cd_hi));
+    _mm_storeu_si128((__m128i*) &to[-3 * vram.width], _mm_unpackhi_epi64(ab_hi, cd_hi));
+}
+
+#else
+
+static void turn_quad(const Vram vram, const Still still, const int x, const int y)
+{
+    for(int j = 0; j < 4; j++)
+    for(int i = 0; i < 4; i++)
+        vram.pixels[x + i + (still.yres - 1 - y - j) * vram.width] = still.pixels[(x + i) * still.yres + y + j];
+}
+
+#endif
+
+static void turn_pixel(const Vram vram, const Still still, const int x, const int y)
+{
+    vram.pixels[x + (still.yres - 1 - y) * vram.width] = still.pixels[x * still.yres + y];
+}
+
+// A frame rendered at full resolution is transposed without stretching.
+static void turn(const Vram vram, const Still still)
+{
+    for(int by = 0; by < still.yres; by += S_BLOCK)
+    for(int bx = 0; bx < still.xres; bx += S_BLOCK)
+    {
+        const int ey = u_min(by + S_BLOCK, still.yres);
+        const int ex = u_min(bx + S_BLOCK, still.xres);
+        int x = bx;
+        for(; x + 4 <= ex; x += 4)
+        {
+            int y = by;
+            for(; y + 4 <= ey; y += 4)
+                turn_quad(vram, still, x, y);
+            for(; y < ey; y++)
+            for(int i = 0; i < 4; i++)
+                turn_pixel(vram, still, x + i, y);
+        }
+        for(; x < ex; x++)
+        for(int y = by; y < ey; y++)
+            turn_pixel(vram, still, x, y);
+    }
+}
+
+// A frame rendered at a lower render scale is stretched over the window as it is transposed.
+static void stretch(const Vram vram, const Still still, const int xres, const int yres)
+{
+    int* const column = u_toss(int, xres);
+    for(int x = 0; x < xres; x++)
+        column[x] = x * still.xres / xres * still.yres;
+    for(int by = 0; by < yres; by += S_BLOCK)
+    for(int bx = 0; bx < xres; bx += S_BLOCK)
+    {
+        const int ey = u_min(by + S_BLOCK, yres);
+        const int ex = u_min(bx + S_BLOCK, xres);
+        for(int y = by; y < ey; y++)
+        {
+            const int row = still.yres - 1 - y * still.yres / yres;
+            uint32_t* const to = &vram.pixels[y * vram.width];
+            for(int x = bx; x < ex; x++)
+                to[x] = still.pixels[column[x] + row];
+        }
+    }
+    free(column);
+}
+
+// The frame is put upright in the window surface, for the renderer to draw sprites and the user interface over in software.
+static void upright(const Sdl sdl, const Still still)
+{
+    const Vram vram = v_lock_surface(sdl.surface);
+    if(still.xres == sdl.xres && still.yres == sdl.yres)
+        turn(vram, still);
+    else
+        stretch(vram, still, sdl.xres, sdl.yres);
+    v_unlock_surface(sdl.surface);
+}
+
 void s_present(const Sdl sdl)
 {
     SDL_RenderPresent(sdl.renderer);
+    if(sdl.surface)
+        SDL_UpdateWindowSurface(sdl.window);
+}
+
+// The depth buffer is as wide as the world was rendered, which can be narrower than the screen.
+static float depth(const Sdl sdl, Point* const zbuff, const int x)
+{
+    return zbuff[x * scaled(sdl.xres, sdl.scale) / sdl.xres].x;
 }
 
-static SDL_Rect left_clip(SDL_Rect seen, const int xres, const Point where, Point* const zbuff)
+static SDL_Rect left_clip(SDL_Rect seen, const Sdl sdl, const Point where, Point* const zbuff)
 {
     for(; seen.w > 0; seen.w--, seen.x++)
     {
         const int x = seen.x;
 
-        if(x < 0 || x >= xres)
+        if(x < 0 || x >= sdl.xres)
             continue;
 
-        if(where.x < zbuff[x].x)
+        if(where.x < depth(sdl, zbuff, x))
             break;
     }
     return seen;
 }
 
-static SDL_Rect rite_clip(SDL_Rect seen, const int xres, const Point where, Point* const zbuff)
+static SDL_Rect rite_clip(SDL_Rect seen, const Sdl sdl, const Point where, Point* const zbuff)
 {
     for(; seen.w > 0; seen.w--)
     {
         const int x = seen.x + seen.w;
 
-        if(x < 0 || x >= xres)
+        if(x < 0 || x >= sdl.xres)
             continue;
 
-        if(where.x < zbuff[x].x)
+        if(where.x < depth(sdl, zbuff, x))
         {
             seen.w = seen.w + 1;
             break;
@@ -55,10 +188,10 @@ static SDL_Rect rite_clip(SDL_Rect seen, const int xres, const Point where, Poin
     return seen;
 }
 
-static SDL_Rect clip(SDL_Rect seen, const int xres, const Point where, Point* const zbuff)
+static SDL_Rect clip(SDL_Rect seen, const Sdl sdl, const Point where, Point* const zbuff)
 {
-    seen = left_clip(seen, xres, where, zbuff);
-    return rite_clip(seen, xres, where, zbuff);
+    seen = left_clip(seen, sdl, where, zbuff);
+    return rite_clip(seen, sdl, where, zbuff);
 }
 
 static void draw_box(const Sdl sdl, const int x, const int y, const int width, const uint32_t color, const int filled)
@@ -85,16 +218,16 @@ static void render_speech(Sprite* const sprite, const Sdl sdl, const Text text,
     }
 }
 
-static SDL_Rect calc_sprite_size(const Sdl sdl, Sprite* const sprite, const Hero hero)
+static SDL_Rect calc_sprite_size(const Sdl sdl, Sprite* const sprite, const Hero hero, const Eye eye)
 {
     // Projection.[ch] does the same thing, but this one accounts for sprite jitter.
-    const int size = sprite->size * hero.fov.a.x * 0.5f * sdl.xres / sprite->where.x;
+    const int size = sprite->size * eye.focal * 0.5f * sdl.xres / sprite->where.x;
     const int osize = u_odd(size) ? size + 1 : size;
     const int my = 0.5f * sdl.yres * (2.0f - hero.pitch);
     const int mx = 0.5f * sdl.xres;
     const int l = mx - osize * 0.5f;
     const int t = my - osize * (1.0f - hero.height / sprite->size);
-    const int s = hero.fov.a.x * mx * p_slope(sprite->where);
+    const int s = eye.focal * mx * p_slope(sprite->where);
     const SDL_Rect target = { l + s, t, osize, osize };
     return target;
 }
@@ -110,7 +243,7 @@ static SDL_Rect calc_state_frame(SDL_Surface* const surface, const State state,
 static void render_one_sprite(const Sdl sdl, const Text text, Sprite* const sprite, const Hero hero, SDL_Texture* const texture, const SDL_Rect image, const SDL_Rect target)
 {
     // Apply lighting to the sprite.
-    const int modding = t_illuminate(hero.torch, sprite->where.x);
+    const int modding = t_fade(t_illuminate(hero.torch, sprite->where.x), 1.0f / sprite->where.x, sdl.distance);
     SDL_SetTextureColorMod(texture, modding, modding, modding);
 
     // Apply transparency to the sprite, if required.
@@ -133,11 +266,11 @@ static void render_one_sprite(const Sdl sdl, const Text text, Sprite* const spri
     render_speech(sprite, sdl, text, target);
 }
 
-static void render_all_sprites(const Sdl sdl, const Text text, const Sprites sprites, Point* const zbuff, const Hero hero, const Timer tm)
+static void render_all_sprites(const Sdl sdl, const Text text, const Sprites sprites, Point* const zbuff, const Hero hero, const Eye eye, const Timer tm)
 {
     s_pull(sprites, hero);
 
-    s_turn(sprites, -hero.yaw);
+    s_turn_in(sprites, eye);
 
     s_sort(sprites, s_furthest_sprite_first);
 
@@ -146,7 +279,7 @@ static void render_all_sprites(const Sdl sdl, const Text text, const Sprites spr
         Sprite* const sprite = &sprites.sprite[which];
         if(sprite->where.x > 0)
         {
-            const SDL_Rect target = calc_sprite_size(sdl, sprite, hero);
+            const SDL_Rect target = calc_sprite_size(sdl, sprite, hero, eye);
             if(target.x + target.w >= 0 && target.x < sdl.xres)
             {
                 const int selected = sprite->ascii - ' ';
@@ -155,7 +288,7 @@ static void render_all_sprites(const Sdl sdl, const Text text, const Sprites spr
                 const State state = sprite->state;
                 const Frame frame = t_lo(tm) ? FRAME_A : FRAME_B;
                 const SDL_Rect image = calc_state_frame(surface, state, frame);
-                sprite->seen = clip(target, sdl.xres, sprite->where, zbuff);
+                sprite->seen = clip(target, sdl, sprite->where, zbuff);
                 if(sprite->seen.w > 0)
                     render_one_sprite(sdl, text, sprite, hero, texture, image, target);
             }
@@ -163,11 +296,35 @@ static void render_all_sprites(const Sdl sdl, const Text text, const Sprites spr
     }
     s_sort(sprites, s_nearest_sprite_first);
 
-    s_turn(sprites, hero.yaw);
+    s_turn_out(sprites, eye);
 
     s_push(sprites, hero);
 }
 
+// The canvas is made anew for the new render scale. The kept frame and depth buffer have room for full resolution.
+Sdl s_rescale(Sdl sdl, const int scale)
+{
+    const int clamped = u_min(u_max(scale, A_SCALE_MIN), A_SCALE_MAX);
+    if(sdl.canvas && clamped == sdl.scale)
+        return sdl;
+
+    // Frames put together in the window surface need no canvas.
+    sdl.scale = clamped;
+    if(sdl.surface)
+        return sdl;
+
+    if(sdl.canvas)
+        SDL_DestroyTexture(sdl.canvas);
+
+    const Sdl v = view(sdl);
+    sdl.canvas = SDL_CreateTexture(
+        sdl.renderer,
+        SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING,
+        v.yres, v.xres); // XRES and YRES swapped since rendering is done 90 degrees on side.
+    return sdl;
+}
+
 Sdl s_setup(const Args args)
 {
     static Sdl zero;
@@ -186,22 +343,47 @@ Sdl s_setup(const Args args)
     if(sdl.window == NULL)
         u_bomb("error: could not open window\n");
 
-    sdl.renderer = SDL_CreateRenderer(
+    sdl.surface = args.software ? SDL_GetWindowSurface(sdl.window) : NULL;
+    if(sdl.surface
+    && sdl.surface->format->format != SDL_PIXELFORMAT_ARGB8888
+    && sdl.surface->format->format != SDL_PIXELFORMAT_RGB888)
+    {
+        printf("warning: the window surface is not 32-bit RGB, frames are put together by the renderer.\n");
+        sdl.surface = NULL;
+    }
+
+    sdl.renderer = sdl.surface ? SDL_CreateSoftwareRenderer(sdl.surface) : SDL_CreateRenderer(
         sdl.window,
         -1,
         SDL_RENDERER_ACCELERATED |
         (args.vsync ? SDL_RENDERER_PRESENTVSYNC : 0x0)); // 933 ms
 
-    sdl.canvas = SDL_CreateTexture(
-        sdl.renderer,
-        SDL_PIXELFORMAT_ARGB8888,
-        SDL_TEXTUREACCESS_STREAMING,
-        args.yres, args.xres); // XRES and YRES swapped since rendering is done 90 degrees on side.
-
     sdl.xres = args.xres;
     sdl.yres = args.yres;
     sdl.fps = args.fps;
+    sdl = s_rescale(sdl, args.scale);
     sdl.threads = args.threads;
+    sdl.simd = SDL_HasAVX2();
+    sdl.distance = args.distance;
+    sdl.checker = args.checker;
+    sdl.rate = args.rate;
+    sdl.segments = args.segments;
+    sdl.crew = c_hire(sdl.threads);
+    sdl.hits = u_toss(Hits, sdl.threads * H_LANES);
+    for(int i = 0; i < sdl.threads * H_LANES; i++)
+        sdl.hits[i] = h_new(64);
+    sdl.gaps = u_toss(Gaps, sdl.threads * B_CHUNK);
+    for(int i = 0; i < sdl.threads * B_CHUNK; i++)
+        sdl.gaps[i] = g_make(64);
+    sdl.fan = u_toss(Fan, 1);
+    *sdl.fan = f_spread(args.xres, args.focal);
+    sdl.edges = u_wipe(Edges, 1);
+    sdl.eye = u_wipe(Eye, 1);
+    sdl.columns = u_toss(Hits, args.xres);
+    for(int i = 0; i < args.xres; i++)
+        sdl.columns[i] = h_new(16);
+    sdl.still = u_toss(Still, 1);
+    *sdl.still = s_film(args.xres, args.yres);
 
     sdl.surfaces = s_load_surfaces(); // 599 ms
 
@@ -568,39 +750,72 @@ void s_draw_room_lookup(const Sdl sdl, const Text yel, const Text red, const Roo
 
 void s_render_playing(const Sdl sdl, const Text text, const Hero hero, const Sprites sprites, const Map map, const Flow current, const Flow clouds, const Timer tm, const Input in)
 {
-    Point* const zbuff = u_toss(Point, sdl.xres);
-    const Line camera = l_rotate(hero.fov, hero.yaw);
-    const Vram vram = v_lock(sdl.canvas);
-
-    // Threaded software rendering - each thread handles vertical columns <a> to <b> of the screen.
+    const Sdl v = view(sdl);
+    *sdl.eye = e_focus(*sdl.eye, hero.where, hero.yaw, hero.fov, hero.pitch, hero.height, v.xres, v.yres);
+    const Eye eye = *sdl.eye;
+    const Rows rows = r_make(v.yres, hero.pitch);
+
+    // Rays are marched out to the draw distance at the edges of the screen, the furthest the draw distance reaches,
+    // so that rays kept by angle reach far enough wherever on the screen the hero turns them.
+    const float cutoff = sdl.distance * p_mag(hero.fov.a) / hero.fov.a.x;
+    *sdl.fan = f_aim(*sdl.fan, hero.where, map, cutoff);
+    const int unmoved = s_unmoved(*sdl.still, hero, map, v.xres, v.yres);
+    const int checkered = sdl.checker && !unmoved && s_steady(*sdl.still, hero, map, v.xres, v.yres);
+    if(checkered)
+        *sdl.still = s_flip(*sdl.still);
+
+    // Edges only face a hero standing outside eye level walls, so a hero stuck in one marches.
+    const int segments = sdl.segments && map.walling[(int) hero.where.y][(int) hero.where.x] == ' ';
+    if(segments)
+        *sdl.edges = e_aim(*sdl.edges, map);
+
+    // Threaded software rendering - each thread takes the next few columns of the screen until none are left.
+    SDL_atomic_t column;
+    SDL_AtomicSet(&column, 0);
     Bundle* const b = u_toss(Bundle, sdl.threads);
     for(int i = 0; i < sdl.threads; i++)
     {
-        b[i].a = (i + 0) * sdl.xres / sdl.threads;
-        b[i].b = (i + 1) * sdl.xres / sdl.threads;
-        b[i].zbuff = zbuff;
-        b[i].camera = camera;
-        b[i].vram = vram;
-        b[i].sdl = sdl;
+        b[i].column = &column;
+        b[i].chunk = B_CHUNK;
+        b[i].hits = &sdl.hits[i * H_LANES];
+        b[i].gaps = &sdl.gaps[i * B_CHUNK];
+        b[i].eye = eye;
+        b[i].cutoff = cutoff;
+        b[i].fan = *sdl.fan;
+        b[i].segments = segments;
+        b[i].edges = *sdl.edges;
+        b[i].band.bot = v.xres * i / sdl.threads;
+        b[i].band.top = v.xres * (i + 1) / sdl.threads;
+        b[i].columns = sdl.columns;
+        b[i].still = *sdl.still;
+        b[i].unmoved = unmoved;
+        b[i].checkered = checkered;
+        b[i].rows = rows;
+        b[i].dark = t_dark(hero.torch, sdl.distance);
+        b[i].sdl = v;
         b[i].hero = hero;
         b[i].current = current;
         b[i].clouds = clouds;
         b[i].map = map;
     };
-    SDL_Thread** const threads = u_toss(SDL_Thread*, sdl.threads);
-    for(int i = 0; i < sdl.threads; i++)
-        threads[i] = SDL_CreateThread(b_raster, "n/a", &b[i]);
-    for(int i = 0; i < sdl.threads; i++)
+    // Columns of an unmoved hero keep the hits projected last frame.
+    if(segments && !unmoved)
+        c_work(sdl.crew, b_project, b, sizeof(*b));
+    c_work(sdl.crew, b_raster, b, sizeof(*b));
+    if(checkered)
+        s_mend(*sdl.still, eye);
+    *sdl.still = s_shoot(*sdl.still, hero, eye, map);
+
+    // Render was done sideways for cache efficiency. Rotate upwards, stretching the render over the screen.
+    if(sdl.surface)
+        upright(sdl, *sdl.still);
+    else
     {
-        int status; // Ignored.
-        SDL_WaitThread(threads[i], &status);
+        develop(sdl, *sdl.still);
+        churn(sdl);
     }
-    v_unlock(sdl.canvas);
-
-    // Render was done sideways for cache efficiency. Rotate upwards.
-    churn(sdl);
 
-    render_all_sprites(sdl, text, sprites, zbuff, hero, tm);
+    render_all_sprites(sdl, text, sprites, sdl.still->zbuff, hero, eye, tm);
 
     // Draw the user interface.
     draw_inventory(sdl, hero.inventory, in);
@@ -608,7 +823,6 @@ void s_render_playing(const Sdl sdl, const Text text, const Hero hero, const Spr
     draw_map(sdl, map, hero.where);
 
     // Cleanup.
-    free(zbuff);
     free(b);
-    free(threads);
+    r_free(rows);
 }
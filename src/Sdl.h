@@ -10,6 +10,12 @@
 #include "Scroll.h"
 #include "Attack.h"
 #include "Text.h"
+#include "Crew.h"
+#include "Hits.h"
+#include "Gaps.h"
+#include "Fan.h"
+#include "Edges.h"
+#include "Still.h"
 
 #include <SDL2/SDL.h>
 
@@ -18,12 +24,32 @@ typedef struct
     SDL_Window* window;
     SDL_Renderer* renderer;
     SDL_Texture* canvas;
+    // The window surface, when frames are put together on the CPU. The renderer then draws to it in software.
+    SDL_Surface* surface;
     int xres;
     int yres;
     int fps;
+    // The world is rendered at this percent of the screen resolution, and stretched over the screen.
+    int scale;
+    // Every other scanline is rendered a frame, and the rest mended from the last frame.
+    int checker;
+    // Far floor and ceiling rows are shaded once for up to this many rows.
+    int rate;
+    // Walls are drawn from the edges of the map, projected onto the screen, instead of marched.
+    int segments;
     Surfaces surfaces;
     Textures textures;
     int threads;
+    int simd;
+    float distance;
+    Crew* crew;
+    Hits* hits;
+    Gaps* gaps;
+    Fan* fan;
+    Edges* edges;
+    Eye* eye;
+    Hits* columns;
+    Still* still;
     int gui;
     uint32_t wht;
     uint32_t blk;
@@ -34,6 +60,8 @@ Sdl;
 
 Sdl s_setup(const Args);
 
+Sdl s_rescale(Sdl, const int scale);
+
 void s_present(const Sdl);
 
 void s_render_playing(const Sdl, const Text, const Hero, const Sprites, const Map, const Flow current, const Flow clouds, const Timer, const Input);
@@ -64,12 +64,21 @@ void s_sort(const Sprites sprites, Sorter sorter)
     qsort(sprites.sprite, sprites.count, sizeof(Sprite), sorter);
 }
 
-void s_turn(const Sprites sprites, const float yaw)
+void s_turn_in(const Sprites sprites, const Eye eye)
 {
     for(int i = 0; i < sprites.count; i++)
     {
         Sprite* const sprite = &sprites.sprite[i];
-        sprite->where = p_turn(sprite->where, yaw);
+        sprite->where = e_turn_in(eye, sprite->where);
+    }
+}
+
+void s_turn_out(const Sprites sprites, const Eye eye)
+{
+    for(int i = 0; i < sprites.count; i++)
+    {
+        Sprite* const sprite = &sprites.sprite[i];
+        sprite->where = e_turn_out(eye, sprite->where);
     }
 }
 
@@ -30,7 +30,9 @@ void s_pull(const Sprites, const Hero);
 
 void s_push(const Sprites, const Hero);
 
-void s_turn(const Sprites, const float yaw);
+void s_turn_in(const Sprites, const Eye);
+
+void s_turn_out(const Sprites, const Eye);
 
 void s_sort(const Sprites, Sorter);
 
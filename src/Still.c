@@ -0,0 +1,121 @@
+#include "Still.h"
+
+#include "util.h"
+
+#include <math.h>
+
+Still s_film(const int xres, const int yres)
+{
+    static Still zero;
+    Still still = zero;
+    still.pixels = u_toss(uint32_t, xres * yres);
+    still.zbuff = u_toss(Point, xres);
+    still.scrolls = u_wipe(Clamped, xres);
+    still.last = u_toss(uint32_t, xres * yres);
+    still.zlast = u_toss(Point, xres);
+    still.stale = u_wipe(char, xres);
+    return still;
+}
+
+int s_unmoved(const Still still, const Hero hero, const Map map, const int xres, const int yres)
+{
+    return still.shot
+        && still.xres == xres
+        && still.yres == yres
+        && still.where.x == hero.where.x
+        && still.where.y == hero.where.y
+        && still.yaw == hero.yaw
+        && still.pitch == hero.pitch
+        && still.height == hero.height
+        && still.light == hero.torch.light
+        && still.walling == map.walling
+        && still.edits == *map.edits;
+}
+
+// Steady frames, of a hero that at most turned a little, can be checkerboarded.
+int s_steady(const Still still, const Hero hero, const Map map, const int xres, const int yres)
+{
+    return still.shot
+        && still.xres == xres
+        && still.yres == yres
+        && still.where.x == hero.where.x
+        && still.where.y == hero.where.y
+        && fabsf(still.yaw - hero.yaw) < S_FAST_TURN
+        && still.pitch == hero.pitch
+        && still.height == hero.height
+        && still.light == hero.torch.light
+        && still.walling == map.walling
+        && still.edits == *map.edits;
+}
+
+// The last frame is kept aside for mending, and the other parity of scanlines is rendered.
+Still s_flip(Still still)
+{
+    uint32_t* const pixels = still.pixels;
+    still.pixels = still.last;
+    still.last = pixels;
+    Point* const zbuff = still.zbuff;
+    still.zbuff = still.zlast;
+    still.zlast = zbuff;
+    still.parity ^= 1;
+    return still;
+}
+
+static void copy(const Still still, const int x, uint32_t* const pixels, Point* const zbuff, const int from)
+{
+    memcpy(&still.pixels[x * still.yres], &pixels[from * still.yres], still.yres * sizeof(*pixels));
+    still.zbuff[x] = zbuff[from];
+}
+
+// Columns sit on a camera line one focal length ahead of the hero, as wide as the screen is. The ray of a column
+// is turned into the view of the last frame, and followed out to its camera line.
+// Only the columns the last frame rendered are taken, as mended columns would smear further with every frame.
+static int find(const Still still, const Eye eye, const int x)
+{
+    const Point ray = eye.columns[x];
+    const Point last = {
+        ray.x * still.cosine + ray.y * still.sine,
+        ray.y * still.cosine - ray.x * still.sine,
+    };
+    if(last.x <= 0.0f)
+        return -1;
+    const float column = (eye.focal * last.y / last.x + 1.0f) * 0.5f * still.xres;
+    const int odd = 1 - still.parity;
+    const int from = 2 * (int) floorf(0.5f * (column + 0.5f - odd)) + odd;
+    return from < 0 || from >= still.xres ? -1 : from;
+}
+
+// Mends the scanlines of a checkerboard frame that were not rendered. The view of the last frame is still in place.
+void s_mend(const Still still, const Eye eye)
+{
+    static Clamped none;
+    for(int x = 1 - still.parity; x < still.xres; x += 2)
+    {
+        const int from = find(still, eye, x);
+        if(from >= 0)
+            copy(still, x, still.last, still.zlast, from);
+        else if(x > 0)
+            copy(still, x, still.pixels, still.zbuff, x - 1);
+        else if(x + 1 < still.xres)
+            copy(still, x, still.pixels, still.zbuff, x + 1);
+        still.scrolls[x] = none;
+        still.stale[x] = true;
+    }
+}
+
+Still s_shoot(Still still, const Hero hero, const Eye eye, const Map map)
+{
+    still.xres = eye.xres;
+    still.yres = eye.yres;
+    still.where = hero.where;
+    still.yaw = hero.yaw;
+    still.cosine = eye.cosine;
+    still.sine = eye.sine;
+    still.pitch = hero.pitch;
+    still.height = hero.height;
+    still.light = hero.torch.light;
+    still.walling = map.walling;
+    still.edits = *map.edits;
+    still.shot = true;
+    return still;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Hero.h"
+#include "Map.h"
+#include "Clamped.h"
+
+#include <stdint.h>
+
+// The world as last rendered, before sprites and the interface were put on top, and the view it was rendered from.
+// While the view stays put the walls, floors and ceilings do not change, so only the rows of each scanline
+// the scrolling sky and water were cast to are rendered again.
+
+// Checkerboard frames render every other scanline, alternating between frames, and mend the scanlines in between.
+// A hero that only turned finds them in the last frame by their angle. Scanlines the last frame did not see
+// get a copy of the scanline next door. A hero that moved, looked up or down, or ducked, sees the world shift
+// differently with distance, so any step, turns faster than this many radians a frame, and a new floor,
+// map edit or render scale, render in full.
+#define S_FAST_TURN (0.1f)
+
+typedef struct
+{
+    // Room for a frame at full resolution. Frames rendered at a lower render scale use the start of each buffer.
+    uint32_t* pixels;
+    Point* zbuff;
+    Clamped* scrolls;
+    int xres;
+    int yres;
+
+    // The last frame, for mending checkerboard frames, and the scanlines that were mended and not rendered.
+    uint32_t* last;
+    Point* zlast;
+    char* stale;
+    int parity;
+
+    Point where;
+    float yaw;
+    float cosine;
+    float sine;
+    float pitch;
+    float height;
+    int light;
+    char** walling;
+    int edits;
+    int shot;
+}
+Still;
+
+Still s_film(const int xres, const int yres);
+
+int s_unmoved(const Still, const Hero, const Map, const int xres, const int yres);
+
+int s_steady(const Still, const Hero, const Map, const int xres, const int yres);
+
+Still s_flip(Still);
+
+void s_mend(const Still, const Eye);
+
+Still s_shoot(Still, const Hero, const Eye, const Map);
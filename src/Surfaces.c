@@ -2,6 +2,8 @@
 
 #include "util.h"
 
+#include <math.h>
+
 static SDL_Surface* load(const char* const path)
 {
     SDL_Surface* const bmp = SDL_LoadBMP(path);
@@ -23,6 +25,98 @@ static SDL_Surface* load(const char* const path)
     return converted;
 }
 
+static Palette match(Palette palette, const SDL_Surface* const surface)
+{
+    const uint32_t* const pixels = (uint32_t*) surface->pixels;
+    for(int i = 0; i < surface->w * surface->h; i++)
+        palette = p_match(palette, pixels[i]);
+    return palette;
+}
+
+static int swizzles(const SDL_Surface* const surface)
+{
+    return surface->w == surface->h && (surface->w & (surface->w - 1)) == 0;
+}
+
+static int count_levels(const int w)
+{
+    int levels = 1;
+    while(w >> levels)
+        levels++;
+    return levels;
+}
+
+// Square power of two surfaces carry their mip levels right behind them, in both layouts.
+static Layout lay(const SDL_Surface* const surface, const int at)
+{
+    static Layout zero;
+    Layout layout = zero;
+    layout.swizzled = swizzles(surface);
+    layout.levels = layout.swizzled ? count_levels(surface->w) : 1;
+    if(layout.levels > L_LEVELS)
+        u_bomb("error: surface of %d pixels carries more than %d mip levels\n", surface->w, L_LEVELS);
+    layout.w = surface->w;
+    layout.h = surface->h;
+    layout.rows = at;
+    layout.zorder = layout.swizzled ? at + s_mip(layout, layout.levels) : at;
+    return layout;
+}
+
+static int size(const Layout layout)
+{
+    return layout.swizzled ? 2 * s_mip(layout, layout.levels) : layout.w * layout.h;
+}
+
+// Shrinks a level of side n to half its side. Each square of four texels is averaged and the nearest
+// of the colors the surface itself uses is picked, so that distant surfaces keep their look.
+static void shrink(uint8_t* const small, const uint8_t* const large, const int n, const Palette palette, const Palette own)
+{
+    const int m = n / 2;
+    for(int row = 0; row < m; row++)
+    for(int col = 0; col < m; col++)
+    {
+        uint32_t r = 0;
+        uint32_t g = 0;
+        uint32_t b = 0;
+        for(int j = 0; j < 2; j++)
+        for(int i = 0; i < 2; i++)
+        {
+            const uint32_t color = palette.color[large[(2 * col + i) + (2 * row + j) * n]];
+            r += 0xFF & (color >> 0x10);
+            g += 0xFF & (color >> 0x08);
+            b += 0xFF & (color >> 0x00);
+        }
+        const int nearest = p_nearest(own, (r / 4) << 0x10 | (g / 4) << 0x08 | (b / 4));
+        small[col + row * m] = p_entry(palette, own.color[nearest]);
+    }
+}
+
+static void fill(uint8_t* const texels, const Layout layout, const SDL_Surface* const surface, const Palette palette)
+{
+    const uint32_t* const pixels = (uint32_t*) surface->pixels;
+    for(int i = 0; i < surface->w * surface->h; i++)
+        texels[layout.rows + i] = p_entry(palette, pixels[i]);
+
+    const Palette own = match(p_empty(), surface);
+    for(int level = 1; level < layout.levels; level++)
+    {
+        uint8_t* const small = &texels[layout.rows + s_mip(layout, level)];
+        const uint8_t* const large = &texels[layout.rows + s_mip(layout, level - 1)];
+        shrink(small, large, layout.w >> (level - 1), palette, own);
+    }
+    p_free(own);
+
+    if(layout.swizzled)
+        for(int level = 0; level < layout.levels; level++)
+        {
+            const int n = layout.w >> level;
+            const int mip = s_mip(layout, level);
+            for(int row = 0; row < n; row++)
+            for(int col = 0; col < n; col++)
+                texels[layout.zorder + mip + s_zorder(col, row)] = texels[layout.rows + mip + col + row * n];
+        }
+}
+
 Surfaces s_load_surfaces(void)
 {
 #pragma message "Maintainer: Apply new sprite pixel art in Surfaces.c::s_load_surfaces"
@@ -160,7 +254,56 @@ Surfaces s_load_surfaces(void)
     for(int i = 0; i < count; i++)
         surface[i] = load(names[i]);
 
-    const Surfaces surfaces = { surface, count };
+    // Art drawn off the palette, like the clouds, adds its own colors to the palette.
+    Palette palette = p_load_palette("art/dawn.pal");
+    for(int i = 0; i < count; i++)
+        palette = match(palette, surface[i]);
+    palette = p_shade(palette);
+
+    Layout* const layout = u_toss(Layout, count);
+    int total = 0;
+    for(int i = 0; i < count; i++)
+    {
+        layout[i] = lay(surface[i], total);
+        total += size(layout[i]);
+    }
+
+    // Padded so that the vector plane casts can gather texels with 32-bit loads.
+    uint8_t* const texels = u_wipe(uint8_t, total + sizeof(int) - 1);
+    for(int i = 0; i < count; i++)
+        fill(texels, layout[i], surface[i], palette);
+
+    const Surfaces surfaces = { surface, texels, layout, palette, count };
 
     return surfaces;
 }
+
+// Interleaves the bits of the column and row, column bits first.
+static int spread(int a)
+{
+    a = (a | a << 8) & 0x00FF00FF;
+    a = (a | a << 4) & 0x0F0F0F0F;
+    a = (a | a << 2) & 0x33333333;
+    a = (a | a << 1) & 0x55555555;
+    return a;
+}
+
+int s_zorder(const int col, const int row)
+{
+    return spread(col) | spread(row) << 1;
+}
+
+// Mip levels of a surface follow one another, each a quarter the size of the last.
+int s_mip(const Layout layout, const int level)
+{
+    const int m = layout.w >> level;
+    return 4 * (layout.w * layout.w - m * m) / 3;
+}
+
+// Picks the mip level for a density of texels per pixel.
+int s_level(const Layout layout, const float density)
+{
+    int exponent = 0;
+    frexpf(density, &exponent);
+    return u_min(u_max(exponent - 1, 0), layout.levels - 1);
+}
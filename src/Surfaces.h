@@ -1,12 +1,26 @@
 #pragma once
 
+#include "Palette.h"
+#include "Layout.h"
+
 #include <SDL2/SDL.h>
 
 typedef struct
 {
     SDL_Surface** surface;
+
+    // The same surfaces as palette indices, all in one flat array for the scanline renderer.
+    uint8_t* texels;
+    Layout* layout;
+    Palette palette;
     int count;
 }
 Surfaces;
 
 Surfaces s_load_surfaces(void);
+
+int s_zorder(const int col, const int row);
+
+int s_mip(const Layout, const int level);
+
+int s_level(const Layout, const float density);
@@ -7,6 +7,28 @@ int t_illuminate(const Torch torch, const float distance)
     return torch.light / distance > 0xFF ? 0xFF : torch.light / distance;
 }
 
+// Illuminates by the inverse of the distance, for casts that never work the distance out.
+int t_shine(const Torch torch, const float inverse)
+{
+    return torch.light * inverse > 0xFF ? 0xFF : torch.light * inverse;
+}
+
+// Fades light into fog, the black every shade falls off to, over the second half of the draw distance.
+// Without a draw distance nothing fades.
+int t_fade(const int light, const float inverse, const float distance)
+{
+    if(distance == 0.0f)
+        return light;
+    const float fog = inverse * distance - 1.0f;
+    return fog > 1.0f ? light : fog < 0.0f ? 0 : light * fog;
+}
+
+// Distance past which the torch, faded by the draw distance, lights nothing.
+float t_dark(const Torch torch, const float distance)
+{
+    return distance == 0.0f ? torch.light : u_min(torch.light, distance);
+}
+
 Torch t_burn(const Torch torch)
 {
     Torch temp = torch;
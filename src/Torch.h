@@ -10,6 +10,12 @@ Torch;
 
 int t_illuminate(const Torch, const float distance);
 
+int t_shine(const Torch, const float inverse);
+
+int t_fade(const int light, const float inverse, const float distance);
+
+float t_dark(const Torch, const float distance);
+
 Torch t_burn(const Torch);
 
 Torch t_snuff(void);
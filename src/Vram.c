@@ -14,6 +14,18 @@ void v_unlock(SDL_Texture* const texture)
     SDL_UnlockTexture(texture);
 }
 
+Vram v_lock_surface(SDL_Surface* const surface)
+{
+    SDL_LockSurface(surface);
+    const Vram vram = { (uint32_t*) surface->pixels, (int) (surface->pitch / sizeof(uint32_t)) };
+    return vram;
+}
+
+void v_unlock_surface(SDL_Surface* const surface)
+{
+    SDL_UnlockSurface(surface);
+}
+
 void v_draw_rooms(const Vram vram, const Map map, const uint32_t in, const uint32_t out)
 {
     for(int y = 1; y < map.rows - 1; y++)
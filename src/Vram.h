@@ -17,6 +17,10 @@ Vram v_lock(SDL_Texture* const);
 
 void v_unlock(SDL_Texture* const);
 
+Vram v_lock_surface(SDL_Surface* const);
+
+void v_unlock_surface(SDL_Surface* const);
+
 void v_draw_rooms(const Vram, const Map, const uint32_t in, const uint32_t out);
 
 void v_draw_dot(const Vram, const Point, const int size, const uint32_t in, const uint32_t out);
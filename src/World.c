@@ -51,6 +51,12 @@ static void attach(const World w)
         m_set_trapdoors(w.map[i], w.map[i - 1].trapdoors, CEILING);
 }
 
+static void survey(const World w)
+{
+    for(int i = 0; i < w.index; i++)
+        m_survey(w.map[i]);
+}
+
 static void populate(const World w, const Timer tm)
 {
     for(int i = 0; i < w.index; i++)
@@ -63,6 +69,7 @@ World w_make(const int max, const Timer tm)
     w = carve(w);
     theme(w);
     attach(w);
+    survey(w);
     populate(w, tm);
     return w;
 }
@@ -55,6 +55,8 @@ int main(int argc, char* argv[])
 
         theme = m_get_theme(theme, world.map[hero.floor], hero.where, tm);
 
+        sdl = s_rescale(sdl, sdl.scale + A_SCALE_STEP * i_rescaling(in));
+
         if(i_using_world_edit_mode(in))
         {
             SDL_SetRelativeMouseMode(SDL_FALSE);
@@ -144,5 +146,7 @@ int main(int argc, char* argv[])
         if(tm.rise)
             fps = 1000.0f / (t2 - t0);
     }
+    c_fire(sdl.crew);
+
     return 0;
 }